@@ -11,8 +11,12 @@ nooverwrite of existing data, existing directories are renamed.
 directories are named *.temp until complete.
 
 demand driven reads.
-headers contain min/max and seek for each grid (VisMF Header Versions 1 and 3).
+headers contain min/max and seek for each grid (VisMF Header Versions 1, 3 and 5).
 data is addressable to a single component of a single grid.
+version 5 compresses each component of each grid, lossless or within a
+relative error bound (vismf.compresstol), with the sizes in the header.
+optional per grid, per component histograms in <name>_Hist
+(vismf.nhistogrambins) for pruning range queries with the min and max.
 no restriction on the relationship between nprocs and nfiles for reading.
 stream throttling for reading to prevent thrashing.
 
@@ -29,6 +33,8 @@ vismf.usepersistentifstreams  (def:  true)
 vismf.usesynchronousreads     (def:  false)
 vismf.usedynamicsetselection  (def:  true)
 vismf.iobuffersize            (def:  VisMF::IO_Buffer_Size)
+vismf.compresstol             (def:  0.0)
+vismf.nhistogrambins          (def:  0)
 amr.plot_nfiles               (def:  64)
 amr.checkpoint_nfiles         (def:  64)
 amr.mffile_nstreams           (def:  1)
@@ -20,6 +20,7 @@
 #include <BoxArray.H>
 #include <MultiFab.H>
 #include <ParallelDescriptor.H>
+#include <ParmParse.H>
 #include <Utility.H>
 
 #ifdef BL_USE_SETBUF
@@ -64,6 +65,28 @@ int main(int argc, char *argv[]) {
       std::cout << "N = " << N << std::endl;
     }
 
+    // ---- nTimes is the number of FillBoundary calls timed for each case.
+    // ---- If abTest is true each case is run with both the point-to-point
+    // ---- messages and the neighbor collective (fabarray.use_neighbor_collective).
+    ParmParse pp;
+    int nTimes(1);
+    bool abTest(false);
+    pp.query("nTimes", nTimes);
+    pp.query("abTest", abTest);
+#ifndef BL_USE_MPI3
+    if(abTest && ParallelDescriptor::IOProcessor()) {
+      std::cout << "**** abTest needs USE_MPI3=TRUE, ignoring it." << std::endl;
+    }
+    abTest = false;
+#endif
+
+    std::vector<bool> useNeighbor;
+    if(abTest) {
+      useNeighbor = { false, true };
+    } else {
+      useNeighbor = { FabArrayBase::use_neighbor_collective };
+    }
+
 
     // Don't restrict ourselves to on-processor communication
     bool local(false);
@@ -105,11 +128,30 @@ int main(int argc, char *argv[]) {
           MultiFab mf(ba, nComp[icomp], nGhost[ighost]);
           mf.setVal(1.0);
 
-          BL_COMM_PROFILE_NAMETAG(nametag.str() + "_Start");
+          for(int inbr(0); inbr < useNeighbor.size(); ++inbr) {
+
+            FabArrayBase::use_neighbor_collective = useNeighbor[inbr];
+            const std::string method(useNeighbor[inbr] ? "_nbr" : "");
+
+            ParallelDescriptor::Barrier();
+            const Real tFB(ParallelDescriptor::second());
+
+            BL_COMM_PROFILE_NAMETAG(nametag.str() + method + "_Start");
+
+            for(int itimes(0); itimes < nTimes; ++itimes) {
+              mf.FillBoundary(local, cross[icross]);
+            }
+
+            BL_COMM_PROFILE_NAMETAG(nametag.str() + method + "_End");
 
-          mf.FillBoundary(local, cross[icross]);
+            Real fbTime(ParallelDescriptor::second() - tFB);
+            ParallelDescriptor::ReduceRealMax(fbTime, ParallelDescriptor::IOProcessorNumber());
 
-          BL_COMM_PROFILE_NAMETAG(nametag.str() + "_End");
+            if(ParallelDescriptor::IOProcessor()) {
+              std::cout << "    " << (useNeighbor[inbr] ? "neighbor collective" : "point-to-point")
+                        << " time per FillBoundary = " << fbTime / nTimes << std::endl;
+            }
+          }
 
         }
       }
@@ -0,0 +1,293 @@
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <BoxLib.H>
+#include <BLassert.H>
+#include <BLCompress.H>
+
+namespace
+{
+    //
+    // The header in front of every compressed buffer: a one-byte mode, a
+    // one-byte keep and the number of values as eight little-endian bytes,
+    // so that streams written to disk can be read on any machine.
+    //
+    enum { STORED = 0, LZ = 1 };
+
+    const int HeaderSize = 10;
+
+    void
+    put_header (unsigned char* out, int mode, int keep, long nvalues)
+    {
+	out[0] = mode;
+	out[1] = keep;
+	const unsigned long long n = nvalues;
+	for (int i = 0; i < 8; ++i)
+	    out[2+i] = (n >> (8*i)) & 0xff;
+    }
+
+    void
+    get_header (const unsigned char* in, int& mode, int& keep, long& nvalues)
+    {
+	mode = in[0];
+	keep = in[1];
+	unsigned long long n = 0;
+	for (int i = 0; i < 8; ++i)
+	    n |= static_cast<unsigned long long>(in[2+i]) << (8*i);
+	nvalues = n;
+    }
+
+    const int  MinMatch = 4;
+    const int  HashBits = 13;
+
+    inline
+    bool
+    little_endian ()
+    {
+	const int one = 1;
+	return *reinterpret_cast<const char*>(&one) == 1;
+    }
+    //
+    // Index of the byte of a value that goes into plane p.  With all bytes
+    // kept the planes are in the order the bytes are stored, which is the
+    // same on every machine for data already converted to a RealDescriptor.
+    // With keep < szvalue the planes are in the order of significance on
+    // this machine, so that the least significant bytes can be dropped;
+    // such streams are only meant for messages.
+    //
+    inline
+    int
+    byte_index (int p, int keep, int szvalue)
+    {
+	return (keep < szvalue && little_endian()) ? szvalue-1-p : p;
+    }
+
+    void
+    corrupt (const char* why)
+    {
+	std::string msg("BLCompress::Decompress(): corrupt stream: ");
+	msg += why;
+	BoxLib::Error(msg.c_str());
+    }
+
+    inline
+    bool
+    put_varint (unsigned long v, unsigned char* out, long& op, long cap)
+    {
+	do {
+	    if (op >= cap) return false;
+	    unsigned char b = v & 0x7f;
+	    v >>= 7;
+	    out[op++] = v ? (b | 0x80) : b;
+	} while (v);
+	return true;
+    }
+
+    inline
+    unsigned long
+    get_varint (const unsigned char* in, long& ip, long insize)
+    {
+	unsigned long v = 0;
+	int shift = 0;
+	unsigned char b;
+	do {
+	    if (ip >= insize)
+		corrupt("truncated");
+	    if (shift >= 64)
+		corrupt("bad length");
+	    b = in[ip++];
+	    v |= static_cast<unsigned long>(b & 0x7f) << shift;
+	    shift += 7;
+	} while (b & 0x80);
+	return v;
+    }
+
+    inline
+    bool
+    put_literals (const unsigned char* in, long n, unsigned char* out, long& op, long cap)
+    {
+	if (!put_varint(n, out, op, cap) || op + n > cap) return false;
+	std::memcpy(out+op, in, n);
+	op += n;
+	return true;
+    }
+    //
+    // Greedy LZ77.  The stream is a sequence of (literal length, literals,
+    // match length - MinMatch, match offset), ending with a literal run.
+    // Returns the compressed size, or -1 if it would exceed cap.
+    //
+    long
+    lz_compress (const unsigned char* in, long n, unsigned char* out, long cap)
+    {
+	std::vector<long> table(1 << HashBits, -1L);
+
+	long ip = 0, anchor = 0, op = 0;
+
+	while (ip + MinMatch <= n)
+	{
+	    unsigned int seq;
+	    std::memcpy(&seq, in+ip, sizeof(seq));
+	    const unsigned int h = (seq * 2654435761u) >> (32 - HashBits);
+
+	    const long ref = table[h];
+	    table[h] = ip;
+
+	    if (ref >= 0 && std::memcmp(in+ref, in+ip, MinMatch) == 0)
+	    {
+		long len = MinMatch;
+		while (ip + len < n && in[ref+len] == in[ip+len]) ++len;
+
+		if (!put_literals(in+anchor, ip-anchor, out, op, cap) ||
+		    !put_varint(len-MinMatch, out, op, cap) ||
+		    !put_varint(ip-ref, out, op, cap))
+		    return -1;
+
+		ip    += len;
+		anchor = ip;
+	    }
+	    else
+	    {
+		++ip;
+	    }
+	}
+
+	if (!put_literals(in+anchor, n-anchor, out, op, cap)) return -1;
+
+	return op;
+    }
+
+    void
+    lz_decompress (const unsigned char* in, long insize, unsigned char* out, long n)
+    {
+	long ip = 0, op = 0;
+
+	while (op < n)
+	{
+	    const unsigned long nlit = get_varint(in, ip, insize);
+	    if (nlit > static_cast<unsigned long>(n-op) ||
+		nlit > static_cast<unsigned long>(insize-ip))
+		corrupt("literals out of bounds");
+	    std::memcpy(out+op, in+ip, nlit);
+	    ip += nlit;
+	    op += nlit;
+
+	    if (op >= n) break;
+
+	    const unsigned long len = get_varint(in, ip, insize);
+	    const unsigned long off = get_varint(in, ip, insize);
+	    if (n-op < MinMatch || len > static_cast<unsigned long>(n-op-MinMatch) ||
+		off == 0 || off > static_cast<unsigned long>(op))
+		corrupt("match out of bounds");
+	    //
+	    // The match may overlap what it is writing, e.g., runs with off == 1.
+	    //
+	    unsigned char* q = out + op;
+	    for (long i = 0, N = len + MinMatch; i < N; ++i)
+		q[i] = q[i-long(off)];
+	    op += len + MinMatch;
+	}
+    }
+}
+
+long
+BLCompress::MaxCompressedSize (long nvalues, int keep)
+{
+    return HeaderSize + nvalues*keep;
+}
+
+long
+BLCompress::Compress (const void* src,
+		      long        nvalues,
+		      int         szvalue,
+		      int         keep,
+		      char*       dst)
+{
+    BL_ASSERT(keep >= 1 && keep <= szvalue && keep <= 255);
+
+    const unsigned char* in = static_cast<const unsigned char*>(src);
+    const long           nb = nvalues*keep;
+
+    std::vector<unsigned char> planes(nb);
+
+    for (int p = 0; p < keep; ++p)
+    {
+	const int            b     = byte_index(p, keep, szvalue);
+	unsigned char*       plane = planes.data() + p*nvalues;
+	const unsigned char* v     = in + b;
+	for (long i = 0; i < nvalues; ++i, v += szvalue)
+	    plane[i] = *v;
+    }
+
+    unsigned char* hdr = reinterpret_cast<unsigned char*>(dst);
+    unsigned char* out = hdr + HeaderSize;
+
+    long nout = nb > 0 ? lz_compress(planes.data(), nb, out, nb) : 0;
+
+    if (nout < 0 || nout >= nb)
+    {
+	put_header(hdr, STORED, keep, nvalues);
+	if (nb > 0) std::memcpy(out, planes.data(), nb);
+	nout = nb;
+    }
+    else
+    {
+	put_header(hdr, LZ, keep, nvalues);
+    }
+
+    return HeaderSize + nout;
+}
+
+void
+BLCompress::Decompress (const char* src,
+			long        srcsize,
+			void*       dst,
+			long        nvalues,
+			int         szvalue)
+{
+    if (srcsize < HeaderSize)
+	corrupt("truncated header");
+
+    int  mode, keep;
+    long nvals;
+    get_header(reinterpret_cast<const unsigned char*>(src), mode, keep, nvals);
+
+    if (nvals != nvalues)
+	corrupt("wrong number of values");
+    if (keep < 1 || keep > szvalue)
+	corrupt("bad value size");
+    if (mode != STORED && mode != LZ)
+	corrupt("bad mode");
+
+    const long           nb     = nvalues*keep;
+    const long           insize = srcsize - HeaderSize;
+    const unsigned char* in     = reinterpret_cast<const unsigned char*>(src) + HeaderSize;
+
+    std::vector<unsigned char> buf;
+    const unsigned char*       planes = in;
+
+    if (mode == LZ)
+    {
+	buf.resize(nb);
+	lz_decompress(in, insize, buf.data(), nb);
+	planes = buf.data();
+    }
+    else if (insize < nb)
+    {
+	corrupt("truncated");
+    }
+
+    unsigned char* out = static_cast<unsigned char*>(dst);
+
+    if (keep < szvalue && nvalues > 0)
+	std::memset(out, 0, nvalues*szvalue);
+
+    for (int p = 0; p < keep; ++p)
+    {
+	const int            b     = byte_index(p, keep, szvalue);
+	const unsigned char* plane = planes + p*nvalues;
+	unsigned char*       v     = out + b;
+	for (long i = 0; i < nvalues; ++i, v += szvalue)
+	    *v = plane[i];
+    }
+}
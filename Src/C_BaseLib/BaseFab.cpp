@@ -7,6 +7,9 @@
 #include <BaseFab.H>
 #include <BArena.H>
 #include <CArena.H>
+#include <HArena.H>
+#include <SArena.H>
+#include <ParmParse.H>
 
 #if !(defined(BL_NO_FORT) || defined(WIN32))
 #include <BaseFab_f.H>
@@ -25,7 +28,8 @@ int BoxLib::BF_init::m_cnt = 0;
 
 namespace
 {
-    Arena* the_arena = 0;
+    Arena*  the_arena  = 0;
+    SArena* the_sarena = 0;
 }
 
 BoxLib::BF_init::BF_init ()
@@ -135,6 +139,9 @@ BoxLib::ResetTotalBytesAllocatedInFabsHWM()
     {
 	private_total_bytes_allocated_in_fabs_hwm = 0;
     }
+
+    if (the_sarena != 0)
+        the_sarena->resetHWM();
 }
 
 void
@@ -154,6 +161,74 @@ BoxLib::update_fab_stats (long n, long s, size_t szt)
     }
 }
 
+void
+BoxLib::InitializeFabArena ()
+{
+    static bool initialized = false;
+
+    if (initialized) return;
+
+    initialized = true;
+
+    ParmParse pp("fab");
+
+    std::string name;
+
+    if (!pp.query("arena", name)) return;
+
+    if (TotalBytesAllocatedInFabs() != 0)
+        BoxLib::Abort("InitializeFabArena(): FABs were allocated before fab.arena was read");
+
+    Arena* arena = 0;
+
+    if (name == "BArena")
+    {
+        arena = new BArena;
+    }
+    else if (name == "CArena")
+    {
+        arena = new CArena;
+    }
+    else if (name == "SArena")
+    {
+        arena = the_sarena = new SArena;
+    }
+    else if (name == "HArena")
+    {
+        arena = new HArena;
+    }
+    else
+    {
+        std::string msg("InitializeFabArena(): unknown fab.arena: ");
+        msg += name;
+        BoxLib::Abort(msg.c_str());
+    }
+
+    delete the_arena;
+
+    the_arena = arena;
+
+#ifdef BL_MEM_PROFILING
+    if (the_sarena != 0)
+    {
+	MemProfiler::add("SArena", std::function<MemProfiler::MemInfo()>
+			 ([] () -> MemProfiler::MemInfo {
+			     const SArena::Stats& s = the_sarena->stats();
+			     return {s.used_bytes, s.used_hwm};
+			 }));
+	MemProfiler::add("SArena", std::function<MemProfiler::NCallsInfo()>
+			 ([] () -> MemProfiler::NCallsInfo {
+			     static long ncalls = 0, nbytes = 0;
+			     const SArena::Stats& s = the_sarena->stats();
+			     MemProfiler::NCallsInfo r = {s.nallocs-ncalls, s.alloc_bytes-nbytes};
+			     ncalls = s.nallocs;
+			     nbytes = s.alloc_bytes;
+			     return r;
+			 }));
+    }
+#endif
+}
+
 Arena*
 BoxLib::The_Arena ()
 {
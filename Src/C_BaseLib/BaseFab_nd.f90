@@ -405,4 +405,38 @@ contains
     end do
   end function fort_fab_dot
 
+
+  ! x = x + a*p and y = z + b*q, with nrm = (max |x|, max |y|) of the results
+  subroutine fort_fab_saxpy2_norm0(lo, hi, x, xlo, xhi, a, p, plo, phi, &
+       y, ylo, yhi, z, zlo, zhi, b, q, qlo, qhi, ncomp, nrm) &
+       bind(c,name='fort_fab_saxpy2_norm0')
+    integer, intent(in) :: lo(3), hi(3), xlo(3), xhi(3), plo(3), phi(3), &
+         ylo(3), yhi(3), zlo(3), zhi(3), qlo(3), qhi(3), ncomp
+    real(c_real), intent(in   ) :: a, b
+    real(c_real), intent(inout) :: x(xlo(1):xhi(1),xlo(2):xhi(2),xlo(3):xhi(3),ncomp)
+    real(c_real), intent(in   ) :: p(plo(1):phi(1),plo(2):phi(2),plo(3):phi(3),ncomp)
+    real(c_real), intent(inout) :: y(ylo(1):yhi(1),ylo(2):yhi(2),ylo(3):yhi(3),ncomp)
+    real(c_real), intent(in   ) :: z(zlo(1):zhi(1),zlo(2):zhi(2),zlo(3):zhi(3),ncomp)
+    real(c_real), intent(in   ) :: q(qlo(1):qhi(1),qlo(2):qhi(2),qlo(3):qhi(3),ncomp)
+    real(c_real), intent(inout) :: nrm(2)
+
+    integer :: i,j,k,n
+    real(c_real) :: xnew, ynew
+
+    do n = 1, ncomp
+       do       k = lo(3), hi(3)
+          do    j = lo(2), hi(2)
+             do i = lo(1), hi(1)
+                xnew = x(i,j,k,n) + a * p(i,j,k,n)
+                ynew = z(i,j,k,n) + b * q(i,j,k,n)
+                x(i,j,k,n) = xnew
+                y(i,j,k,n) = ynew
+                nrm(1) = max(nrm(1), abs(xnew))
+                nrm(2) = max(nrm(2), abs(ynew))
+             end do
+          end do
+       end do
+    end do
+  end subroutine fort_fab_saxpy2_norm0
+
 end module basefab_nd_module
@@ -1,8 +1,12 @@
 
+#include <algorithm>
+
 #include <BLassert.H>
 #include <BoxArray.H>
+#include <DistributionMapping.H>
 #include <ParallelDescriptor.H>
 #include <Utility.H>
+#include <BLProfiler.H>
 
 #ifdef BL_MEM_PROFILING
 #include <MemProfiler.H>
@@ -15,15 +19,53 @@ long BARef::total_hash_bytes_hwm = 0L;
 #endif
 
 bool    BARef::initialized = false;
+long    BARef::next_pack_id = 0;
 bool BoxArray::initialized = false;
 
 BoxArray::CBACache BoxArray::m_CoarseBoxArrayCache;
 
 namespace {
     const int bl_ignore_max = 100000;
+
+    inline
+    void
+    put_varint (int v, std::vector<unsigned char>& out)
+    {
+	unsigned int u = (static_cast<unsigned int>(v) << 1) ^ static_cast<unsigned int>(v >> 31);
+	while (u >= 0x80) {
+	    out.push_back(static_cast<unsigned char>(u | 0x80));
+	    u >>= 7;
+	}
+	out.push_back(static_cast<unsigned char>(u));
+    }
+
+    inline
+    int
+    get_varint (const unsigned char*& in)
+    {
+	unsigned int u = 0;
+	int shift = 0;
+	unsigned char b;
+	do {
+	    b = *in++;
+	    u |= static_cast<unsigned int>(b & 0x7f) << shift;
+	    shift += 7;
+	} while (b & 0x80);
+	return static_cast<int>(u >> 1) ^ -static_cast<int>(u & 1);
+    }
+    //
+    // The last block decoded by this thread, as small and big ends.
+    //
+    long cache_id  = -1;
+    long cache_blk = -1;
+    int  cache_box[BARef::PackBlock][2*BL_SPACEDIM];
+#ifdef _OPENMP
+#pragma omp threadprivate(cache_id,cache_blk,cache_box)
+#endif
 }
 
 BARef::BARef () 
+    : m_npacked(0), m_pack_id(0)
 { 
 #ifdef BL_MEM_PROFILING
     updateMemoryUsage_box(1);
@@ -31,7 +73,7 @@ BARef::BARef ()
 }
 
 BARef::BARef (size_t size) 
-    : m_abox(size) 
+    : m_abox(size), m_npacked(0), m_pack_id(0)
 { 
 #ifdef BL_MEM_PROFILING
     updateMemoryUsage_box(1);
@@ -39,17 +81,25 @@ BARef::BARef (size_t size)
 }
  
 BARef::BARef (const BoxList& bl)
+    : m_npacked(0), m_pack_id(0)
 { 
     define(bl); 
 }
 
 BARef::BARef (std::istream& is)
+    : m_npacked(0), m_pack_id(0)
 { 
     define(is); 
 }
 
 BARef::BARef (const BARef& rhs) 
-    : m_abox(rhs.m_abox) // don't copy hash
+    : m_abox(rhs.m_abox), // don't copy hash
+      m_npacked(rhs.m_npacked),
+      m_pack_id(rhs.m_pack_id),
+      m_packed(rhs.m_packed),
+      m_block(rhs.m_block),
+      m_local_ids(rhs.m_local_ids),
+      m_local(rhs.m_local)
 {
 #ifdef BL_MEM_PROFILING
     updateMemoryUsage_box(1);
@@ -117,12 +167,13 @@ BARef::define (const BoxList& bl)
 
 void 
 BARef::resize (long n) {
+    unpack();
 #ifdef BL_MEM_PROFILING
     updateMemoryUsage_box(-1);
     updateMemoryUsage_hash(-1);
 #endif
     m_abox.resize(n);
-    hash.clear();
+    clear_hash();
 #ifdef BL_MEM_PROFILING
     updateMemoryUsage_box(1);
 #endif
@@ -132,8 +183,9 @@ BARef::resize (long n) {
 void
 BARef::updateMemoryUsage_box (int s)
 {
-    if (m_abox.size() > 1) {
-	long b = BoxLib::bytesOf(m_abox);
+    if (size() > 1) {
+	long b = BoxLib::bytesOf(m_abox) + BoxLib::bytesOf(m_packed) + BoxLib::bytesOf(m_block)
+	    + BoxLib::bytesOf(m_local_ids) + BoxLib::bytesOf(m_local);
 	if (s > 0) {
 	    total_box_bytes += b;
 	    total_box_bytes_hwm = std::max(total_box_bytes_hwm, total_box_bytes);
@@ -149,12 +201,8 @@ BARef::updateMemoryUsage_box (int s)
 void
 BARef::updateMemoryUsage_hash (int s)
 {
-    if (hash.size() > 0) {
-	long b = sizeof(hash);
-	for (const auto& x: hash) {
-	    b += BoxLib::gcc_map_node_extra_bytes
-		+ sizeof(IntVect) + BoxLib::bytesOf(x.second);
-	}
+    if (HasHash()) {
+	long b = BoxLib::bytesOf(hash_offset) + BoxLib::bytesOf(hash_boxes);
 	if (s > 0) {
 	    total_hash_bytes += b;
 	    total_hash_bytes_hwm = std::max(total_hash_bytes_hwm, total_hash_bytes);
@@ -165,6 +213,161 @@ BARef::updateMemoryUsage_hash (int s)
 }
 #endif
 
+void
+BARef::pack (const std::vector<int>& local_ids)
+{
+    if (packed() || m_abox.empty()) return;
+
+    BL_PROFILE("BARef::pack()");
+
+#ifdef BL_MEM_PROFILING
+    updateMemoryUsage_box(-1);
+    updateMemoryUsage_hash(-1);
+#endif
+    clear_hash();
+
+    const long N = m_abox.size();
+
+    std::vector<unsigned char>().swap(m_packed);
+    m_block.resize((N+PackBlock-1)/PackBlock);
+
+    IntVect lo, len;
+
+    for (long i = 0; i < N; ++i)
+    {
+	if (i % PackBlock == 0)
+	{
+	    m_block[i/PackBlock] = m_packed.size();
+	    lo  = IntVect::TheZeroVector();
+	    len = IntVect::TheZeroVector();
+	}
+
+	const Box& bx = m_abox[i];
+	BL_ASSERT(bx.ixType().cellCentered());
+
+	for (int d = 0; d < BL_SPACEDIM; ++d)
+	{
+	    put_varint(bx.smallEnd(d) - lo[d], m_packed);
+	    put_varint(bx.length(d) - len[d], m_packed);
+	}
+
+	lo  = bx.smallEnd();
+	len = bx.size();
+    }
+
+    std::vector<unsigned char>(m_packed).swap(m_packed);
+
+    m_local_ids = local_ids;
+    m_local.resize(local_ids.size());
+    for (int k = 0, M = local_ids.size(); k < M; ++k)
+	m_local[k] = m_abox[local_ids[k]];
+
+    Array<Box>().swap(m_abox);
+
+    m_npacked = N;
+#ifdef _OPENMP
+#pragma omp atomic capture
+#endif
+    m_pack_id = ++next_pack_id;
+
+#ifdef BL_MEM_PROFILING
+    updateMemoryUsage_box(1);
+#endif
+}
+
+void
+BARef::unpack ()
+{
+    if (!packed()) return;
+
+#ifdef BL_MEM_PROFILING
+    updateMemoryUsage_box(-1);
+#endif
+    const long N = m_npacked;
+
+    m_abox.resize(N);
+
+    const unsigned char* in = m_packed.empty() ? 0 : &m_packed[0];
+
+    IntVect lo, len;
+
+    for (long i = 0; i < N; ++i)
+    {
+	if (i % PackBlock == 0)
+	{
+	    lo  = IntVect::TheZeroVector();
+	    len = IntVect::TheZeroVector();
+	}
+
+	for (int d = 0; d < BL_SPACEDIM; ++d)
+	{
+	    lo[d]  += get_varint(in);
+	    len[d] += get_varint(in);
+	}
+
+	m_abox[i] = Box(lo, lo+len-1);
+    }
+
+    m_npacked = 0;
+    std::vector<unsigned char>().swap(m_packed);
+    std::vector<long>().swap(m_block);
+    std::vector<int>().swap(m_local_ids);
+    Array<Box>().swap(m_local);
+
+#ifdef BL_MEM_PROFILING
+    updateMemoryUsage_box(1);
+#endif
+}
+
+Box
+BARef::packed_box (long i) const
+{
+    BL_ASSERT(i >= 0 && i < m_npacked);
+
+    if (!m_local_ids.empty())
+    {
+	std::vector<int>::const_iterator it
+	    = std::lower_bound(m_local_ids.begin(), m_local_ids.end(), int(i));
+	if (it != m_local_ids.end() && *it == i)
+	    return m_local[it - m_local_ids.begin()];
+    }
+
+    const long ib = i / PackBlock;
+
+    if (cache_id != m_pack_id || cache_blk != ib)
+    {
+	const unsigned char* in  = &m_packed[m_block[ib]];
+	const int            nbx = std::min(long(PackBlock), m_npacked - ib*PackBlock);
+
+	int lo[BL_SPACEDIM] = {0}, len[BL_SPACEDIM] = {0};
+
+	for (int k = 0; k < nbx; ++k)
+	{
+	    for (int d = 0; d < BL_SPACEDIM; ++d)
+	    {
+		lo[d]  += get_varint(in);
+		len[d] += get_varint(in);
+		cache_box[k][d]             = lo[d];
+		cache_box[k][d+BL_SPACEDIM] = lo[d] + len[d] - 1;
+	    }
+	}
+
+	cache_id  = m_pack_id;
+	cache_blk = ib;
+    }
+
+    const int* b = cache_box[i - ib*PackBlock];
+
+    return Box(IntVect(b), IntVect(b+BL_SPACEDIM));
+}
+
+void
+BARef::clear_hash ()
+{
+    std::vector<int>().swap(hash_offset);
+    std::vector<int>().swap(hash_boxes);
+}
+
 void
 BARef::Initialize ()
 {
@@ -296,25 +499,26 @@ BoxArray::resize (long len)
     } else {
         uniqify();
     }
+    m_ref->unpack();
     m_ref->resize(len);
 }
 
 long
 BoxArray::size () const
 {
-    return m_ref->m_abox.size();
+    return m_ref->size();
 }
 
 long
 BoxArray::capacity () const
 {
-    return m_ref->m_abox.capacity();
+    return m_ref->packed() ? m_ref->size() : m_ref->m_abox.capacity();
 }
 
 bool
 BoxArray::empty () const
 {
-    return m_ref->m_abox.empty();
+    return m_ref->size() == 0;
 }
 
 long
@@ -379,8 +583,7 @@ BoxArray::writeOn (std::ostream& os) const
 bool
 BoxArray::operator== (const BoxArray& rhs) const
 {
-    return m_transformer->equal(*rhs.m_transformer)
-	&& (m_ref == rhs.m_ref || m_ref->m_abox == rhs.m_ref->m_abox);
+    return m_transformer->equal(*rhs.m_transformer) && CellEqual(rhs);
 }
 
 bool
@@ -392,7 +595,23 @@ BoxArray::operator!= (const BoxArray& rhs) const
 bool
 BoxArray::CellEqual (const BoxArray& rhs) const
 {
-    return m_ref == rhs.m_ref || m_ref->m_abox == rhs.m_ref->m_abox;
+    if (m_ref == rhs.m_ref) return true;
+
+    if (!m_ref->packed() && !rhs.m_ref->packed())
+	return m_ref->m_abox == rhs.m_ref->m_abox;
+
+    if (m_ref->packed() && rhs.m_ref->packed())
+	return m_ref->m_npacked == rhs.m_ref->m_npacked && m_ref->m_packed == rhs.m_ref->m_packed;
+
+    const long N = size();
+
+    if (rhs.size() != N) return false;
+
+    for (long i = 0; i < N; ++i)
+	if (m_ref->box(i) != rhs.m_ref->box(i))
+	    return false;
+
+    return true;
 }
 
 BoxArray&
@@ -431,6 +650,7 @@ BoxArray::refine (const IntVect& iv)
     } else {
         uniqify();
     }
+    m_ref->unpack();
     const int N = m_ref->m_abox.size();
 #ifdef _OPENMP
 #pragma omp parallel for
@@ -467,6 +687,7 @@ BoxArray::coarsen (const IntVect& iv)
     else // build a new one
     {
 	uniqify();
+	m_ref->unpack();
 
 	const int N = m_ref->m_abox.size();
 #ifdef _OPENMP
@@ -492,6 +713,7 @@ BoxArray::growcoarsen (int n, const IntVect& iv)
     } else {
         uniqify();
     }
+    m_ref->unpack();
     const int N = m_ref->m_abox.size();
 #ifdef _OPENMP
 #pragma omp parallel for
@@ -509,6 +731,7 @@ BoxArray::grow (int n)
     } else {
         uniqify();
     }
+    m_ref->unpack();
     const int N = m_ref->m_abox.size();
 #ifdef _OPENMP
 #pragma omp parallel for
@@ -526,6 +749,7 @@ BoxArray::grow (const IntVect& iv)
     } else {
         uniqify();
     }
+    m_ref->unpack();
     const int N = m_ref->m_abox.size();
 #ifdef _OPENMP
 #pragma omp parallel for
@@ -544,6 +768,7 @@ BoxArray::grow (int dir,
     } else {
         uniqify();
     }
+    m_ref->unpack();
     const int N = m_ref->m_abox.size();
 #ifdef _OPENMP
 #pragma omp parallel for
@@ -599,6 +824,7 @@ BoxArray::convert (Box (*fp)(const Box&))
     } else {
         uniqify();
     }
+    m_ref->unpack();
     const int N = size();
     for (int i = 0; i < N; ++i)
 	set(i,fp(get(i)));
@@ -614,6 +840,7 @@ BoxArray::shift (int dir,
     } else {
         uniqify();
     }
+    m_ref->unpack();
     const int N = m_ref->m_abox.size();
 #ifdef _OPENMP
 #pragma omp parallel for
@@ -631,6 +858,7 @@ BoxArray::shift (const IntVect& iv)
     } else {
         uniqify();
     }
+    m_ref->unpack();
     const int N = m_ref->m_abox.size();
 #ifdef _OPENMP
 #pragma omp parallel for
@@ -649,6 +877,7 @@ BoxArray::shiftHalf (int dir,
     } else {
         uniqify();
     }
+    m_ref->unpack();
     const int N = m_ref->m_abox.size();
 #ifdef _OPENMP
 #pragma omp parallel for
@@ -666,6 +895,7 @@ BoxArray::shiftHalf (const IntVect& iv)
     } else {
         uniqify();
     }
+    m_ref->unpack();
     const int N = m_ref->m_abox.size();
 #ifdef _OPENMP
 #pragma omp parallel for
@@ -687,8 +917,11 @@ BoxArray::set (int        i,
 	} else {
 	    uniqify();
 	}
+	m_ref->unpack();
     }
 
+    BL_ASSERT(!m_ref->packed());
+
     m_ref->m_abox[i] = BoxLib::enclosedCells(ibox);
 }
 
@@ -811,9 +1044,9 @@ BoxArray::minimalBox () const
     const int N = size();
     if (N > 0)
     {
-        minbox = m_ref->m_abox[0];
+        minbox = m_ref->box(0);
 	for (int i = 1; i < N; ++i)
-            minbox.minBox(m_ref->m_abox[i]);
+            minbox.minBox(m_ref->box(i));
     }
     minbox.convert(ixType());
     return minbox;
@@ -861,11 +1094,11 @@ BoxArray::intersections (const Box&                         bx,
 {
     // called too many times  BL_PROFILE("BoxArray::intersections()");
 
-    BARef::HashType& BoxHashMap = getHashMap();
+    getHashMap();
 
     isects.resize(0);
 
-    if (!BoxHashMap.empty())
+    if (m_ref->HasHash())
     {
         BL_ASSERT(bx.ixType() == ixType());
 
@@ -887,32 +1120,58 @@ BoxArray::intersections (const Box&                         bx,
 
 	if (!cbx.intersects(m_ref->bbox)) return;
 
-	BARef::HashType::const_iterator TheEnd = BoxHashMap.end();
+	cbx &= m_ref->bbox;
+	//
+	// The bins of a row of cbx in the first direction are adjacent, so
+	// their boxes are one contiguous range of hash_boxes.
+	//
+	const Box&  bbox   = m_ref->bbox;
+	const int*  offset = &(m_ref->hash_offset[0]);
+	const int*  boxes  = &(m_ref->hash_boxes[0]);
+	const int   len    = cbx.length(0);
 
-        for (IntVect iv = cbx.smallEnd(), End = cbx.bigEnd(); iv <= End; cbx.next(iv))
+	Box rows(cbx);
+	rows.setBig(0, cbx.smallEnd(0));
+
+        for (IntVect iv = rows.smallEnd(), End = rows.bigEnd(); iv <= End; rows.next(iv))
         {
-            BARef::HashType::const_iterator it = BoxHashMap.find(iv);
+	    const long b = bbox.index(iv);
 
-            if (it != TheEnd)
-            {
-                for (std::vector<int>::const_iterator v_it = it->second.begin(), v_end = it->second.end();
-                     v_it != v_end;
-                     ++v_it)
-                {
-                    const int  index = *v_it;
-                    const Box& isect = bx & BoxLib::grow(get(index),ng);
-
-                    if (isect.ok())
-                    {
-                        isects.push_back(std::pair<int,Box>(index,isect));
-			if (first_only) return;
-                    }
-                }
-            }
+	    for (int k = offset[b], kend = offset[b+len]; k < kend; ++k)
+	    {
+		const int  index = boxes[k];
+		const Box& isect = bx & BoxLib::grow(get(index),ng);
+
+		if (isect.ok())
+		{
+		    isects.push_back(std::pair<int,Box>(index,isect));
+		    if (first_only) return;
+		}
+	    }
         }
     }
 }
 
+void
+BoxArray::intersections (const Array<Box>&                           bxs,
+			 Array< std::vector< std::pair<int,Box> > >& isects,
+			 int                                         ng) const
+{
+    BL_PROFILE("BoxArray::intersections(Array)");
+
+    getHashMap();
+
+    const int N = bxs.size();
+
+    isects.resize(N);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic,16)
+#endif
+    for (int i = 0; i < N; ++i)
+	intersections(bxs[i], isects[i], false, ng);
+}
+
 BoxList
 BoxArray::complement (const Box& bx) const
 {
@@ -920,7 +1179,7 @@ BoxArray::complement (const Box& bx) const
 
     if (!empty()) 
     {
-	BARef::HashType& BoxHashMap = getHashMap();
+	getHashMap();
 
 	BL_ASSERT(bx.ixType() == ixType());
 
@@ -940,34 +1199,39 @@ BoxArray::complement (const Box& bx) const
         Box cbx(sm,bg);
         cbx.normalize();
 
-	BARef::HashType::const_iterator TheEnd = BoxHashMap.end();
+	if (!cbx.intersects(m_ref->bbox)) return bl;
+
+	cbx &= m_ref->bbox;
+
+	const Box&  bbox   = m_ref->bbox;
+	const int*  offset = &(m_ref->hash_offset[0]);
+	const int*  boxes  = &(m_ref->hash_boxes[0]);
+	const int   len    = cbx.length(0);
 
-	for (IntVect iv = cbx.smallEnd(), End = cbx.bigEnd(); 
+	Box rows(cbx);
+	rows.setBig(0, cbx.smallEnd(0));
+
+	for (IntVect iv = rows.smallEnd(), End = rows.bigEnd(); 
 	     iv <= End && bl.isNotEmpty(); 
-	     cbx.next(iv))
+	     rows.next(iv))
         {
-            BARef::HashType::const_iterator it = BoxHashMap.find(iv);
+	    const long b = bbox.index(iv);
 
-            if (it != TheEnd)
-            {
-                for (std::vector<int>::const_iterator v_it = it->second.begin(), v_end = it->second.end(); 
-		     v_it != v_end && bl.isNotEmpty(); 
-		     ++v_it)
-                {
-                    const int  index = *v_it;
-                    const Box& isect = bx & get(index);
-
-                    if (isect.ok())
-                    {
-			for (BoxList::iterator bli = bl.begin(); bli != bl.end(); )
-			{
-			    BoxList diff = BoxLib::boxDiff(*bli, isect);
-			    bl.splice_front(diff);
-			    bl.remove(bli++);
-			}
-                    }
-                }
-            }
+	    for (int k = offset[b], kend = offset[b+len]; k < kend && bl.isNotEmpty(); ++k)
+	    {
+		const int  index = boxes[k];
+		const Box& isect = bx & get(index);
+
+		if (isect.ok())
+		{
+		    for (BoxList::iterator bli = bl.begin(); bli != bl.end(); )
+		    {
+			BoxList diff = BoxLib::boxDiff(*bli, isect);
+			bl.splice_front(diff);
+			bl.remove(bli++);
+		    }
+		}
+	    }
         }
     }
 
@@ -977,12 +1241,12 @@ BoxArray::complement (const Box& bx) const
 void
 BoxArray::clear_hash_bin () const
 {
-    if (!m_ref->hash.empty())
+    if (m_ref->HasHash())
     {
 #ifdef BL_MEM_PROFILING
 	m_ref->updateMemoryUsage_hash(-1);
 #endif
-        m_ref->hash.clear();
+        m_ref->clear_hash();
     }
 }
 
@@ -997,44 +1261,72 @@ BoxArray::removeOverlap ()
     if (!m_ref.unique()) {
         uniqify();
     }
+    m_ref->unpack();
+    //
+    // The hash bins cannot grow, so we search the original boxes and
+    // follow each of them to the pieces that have replaced it.
+    //
+    BoxArray orig(*this);
+    orig.uniqify();
 
-    BARef::HashType& BoxHashMap = m_ref->hash;
+    const int N = size();
+
+    std::vector< std::vector<int> > pieces(N);
 
     BoxList bl;
 
     const Box EmptyBox;
 
     std::vector< std::pair<int,Box> > isects;
+
+    std::vector<int> stack;
     //
     // Note that "size()" can increase in this loop!!!
     //
 #ifdef BL_MEM_PROFILING
     m_ref->updateMemoryUsage_box(-1);
-    m_ref->updateMemoryUsage_hash(-1);
-    long total_hash_bytes_save = m_ref->total_hash_bytes;
 #endif
     for (int i = 0; i < size(); i++)
     {
         if (m_ref->m_abox[i].ok())
         {
-            intersections(m_ref->m_abox[i],isects);
+	    const Box bxi = m_ref->m_abox[i];
+
+            orig.intersections(bxi,isects);
 
-            for (int j = 0, N = isects.size(); j < N; j++)
+            for (int j = 0, M = isects.size(); j < M; j++)
             {
-                if (isects[j].first == i) continue;
+		stack.push_back(isects[j].first);
+
+		while (!stack.empty())
+		{
+		    const int k = stack.back();
+		    stack.pop_back();
+
+		    if (!pieces[k].empty())
+		    {
+			stack.insert(stack.end(), pieces[k].rbegin(), pieces[k].rend());
+			continue;
+		    }
+
+		    if (k == i) continue;
+
+		    const Box& isect = bxi & m_ref->m_abox[k];
 
-                Box& bx = m_ref->m_abox[isects[j].first];
+		    if (!isect.ok()) continue;
 
-                bl = BoxLib::boxDiff(bx, isects[j].second);
+		    bl = BoxLib::boxDiff(m_ref->m_abox[k], isect);
 
-                bx = EmptyBox;
+		    m_ref->m_abox[k] = EmptyBox;
 
-                for (BoxList::const_iterator it = bl.begin(), End = bl.end(); it != End; ++it)
-                {
-                    m_ref->m_abox.push_back(*it);
+		    for (BoxList::const_iterator it = bl.begin(), End = bl.end(); it != End; ++it)
+		    {
+			m_ref->m_abox.push_back(*it);
 
-                    BoxHashMap[BoxLib::coarsen(it->smallEnd(),m_ref->crsn)].push_back(size()-1);
-                }
+			pieces[k].push_back(size()-1);
+			pieces.push_back(std::vector<int>());
+		    }
+		}
             }
         }
     }
@@ -1046,28 +1338,26 @@ BoxArray::removeOverlap ()
     //
     bl.clear();
 
-    const Box& bb = m_ref->bbox;
-
-    BARef::HashType::const_iterator TheEnd = BoxHashMap.end();
+    const std::vector<int>& binned = orig.m_ref->hash_boxes;
 
-    for (IntVect iv = bb.smallEnd(), End = bb.bigEnd(); iv <= End; bb.next(iv))
+    for (int j = 0, M = binned.size(); j < M; ++j)
     {
-        BARef::HashType::const_iterator it = BoxHashMap.find(iv);
+	stack.push_back(binned[j]);
 
-        if (it != TheEnd)
-        {
-            for (std::vector<int>::const_iterator v_it = it->second.begin(), v_end = it->second.end();
-                 v_it != v_end;
-                 ++v_it)
-            {
-                const int index = *v_it;
+	while (!stack.empty())
+	{
+	    const int k = stack.back();
+	    stack.pop_back();
 
-                if (m_ref->m_abox[index].ok())
-                {
-                    bl.push_back(m_ref->m_abox[index]);
-                }
-            }
-        }
+	    if (!pieces[k].empty())
+	    {
+		stack.insert(stack.end(), pieces[k].rbegin(), pieces[k].rend());
+	    }
+	    else if (m_ref->m_abox[k].ok())
+	    {
+		bl.push_back(m_ref->m_abox[k]);
+	    }
+	}
     }
 
     bl.simplify();
@@ -1076,10 +1366,6 @@ BoxArray::removeOverlap ()
 
     *this = nba;
 
-#ifdef BL_MEM_PROFILING
-    m_ref->total_hash_bytes = total_hash_bytes_save;
-#endif
-
     BL_ASSERT(isDisjoint());
 }
 
@@ -1127,53 +1413,175 @@ BoxArray::type_update ()
     }
 }
 
-BARef::HashType&
+void
 BoxArray::getHashMap () const
 {
-    BARef::HashType& BoxHashMap = m_ref->hash;
-
 #ifdef _OPENMP
     #pragma omp critical(intersections_lock)
 #endif
     {
-        if (BoxHashMap.empty() && size() > 0)
+        if (!m_ref->HasHash() && size() > 0)
         {
+	    BL_PROFILE("BoxArray::getHashMap()");
+
+	    const int N = size();
             //
-            // Calculate the bounding box & maximum extent of the boxes.
+            // Calculate the maximum extent of the boxes & the range of their small ends.
             //
 	    IntVect maxext = IntVect::TheUnitVector();
+	    IntVect lo     = IntVect::TheMaxVector();
+	    IntVect hi     = IntVect::TheMinVector();
 
-	    const int N = size();
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+	    {
+		IntVect tmaxext = IntVect::TheUnitVector();
+		IntVect tlo     = IntVect::TheMaxVector();
+		IntVect thi     = IntVect::TheMinVector();
 
+#ifdef _OPENMP
+#pragma omp for schedule(static) nowait
+#endif
+		for (int i = 0; i < N; ++i)
+		{
+		    const Box& bx = m_ref->box(i);
+		    tmaxext = BoxLib::max(tmaxext, bx.size());
+		    tlo     = BoxLib::min(tlo, bx.smallEnd());
+		    thi     = BoxLib::max(thi, bx.smallEnd());
+		}
+
+#ifdef _OPENMP
+#pragma omp critical(hash_extent)
+#endif
+		{
+		    maxext = BoxLib::max(maxext, tmaxext);
+		    lo     = BoxLib::min(lo, tlo);
+		    hi     = BoxLib::max(hi, thi);
+		}
+	    }
+	    //
+	    // Use bigger bins if there would be many more bins than boxes,
+	    // e.g., for a few boxes scattered over a large domain.
+	    //
+	    IntVect crsn = maxext;
+	    Box     bbox(BoxLib::coarsen(lo,crsn), BoxLib::coarsen(hi,crsn));
+
+	    const long maxbins = std::max(64L, 8L*N);
+
+	    while (bbox.numPts() > maxbins)
+	    {
+		int d;
+		bbox.longside(d);
+		crsn[d] *= 2;
+		bbox = Box(BoxLib::coarsen(lo,crsn), BoxLib::coarsen(hi,crsn));
+	    }
+
+	    const long nbins = bbox.numPts();
+	    //
+	    // Counting sort of the boxes by bin.
+	    //
+	    std::vector<int> bin(N);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
 	    for (int i = 0; i < N; ++i)
-            {
-                const Box& bx = m_ref->m_abox[i];
-                maxext = BoxLib::max(maxext, bx.size());
-            }
+	    {
+		const Box& bx = m_ref->box(i);
+		bin[i] = bbox.index(BoxLib::coarsen(bx.smallEnd(),crsn));
+	    }
 
-	    IntVect lob = IntVect::TheMaxVector();
-	    IntVect hib = IntVect::TheMinVector();
+	    std::vector<int>& offset = m_ref->hash_offset;
+	    std::vector<int>& boxes  = m_ref->hash_boxes;
 
-            for (int i = 0; i < N; i++)
-            {
-                const IntVect& crsnsmlend 
-		    = BoxLib::coarsen(m_ref->m_abox[i].smallEnd(),maxext);
-                BoxHashMap[crsnsmlend].push_back(i);
-		lob = BoxLib::min(lob, crsnsmlend);
-		hib = BoxLib::max(hib, crsnsmlend);
-            }
+	    std::vector<int> count(nbins+1, 0);
 
-            m_ref->crsn = maxext;
-            m_ref->bbox = Box(lob,hib);
-            m_ref->bbox.normalize();
+	    for (int i = 0; i < N; ++i)
+		++count[bin[i]+1];
+
+	    for (long b = 0; b < nbins; ++b)
+		count[b+1] += count[b];
+
+	    boxes.resize(N);
+
+	    offset = count;
+
+	    for (int i = 0; i < N; ++i)
+		boxes[count[bin[i]]++] = i;
+
+            m_ref->crsn = crsn;
+            m_ref->bbox = bbox;
 	    
 #ifdef BL_MEM_PROFILING
 	    m_ref->updateMemoryUsage_hash(1);
 #endif
         }
     }
+}
 
-    return BoxHashMap;
+void
+BoxArray::compress ()
+{
+    m_ref->pack(std::vector<int>());
+}
+
+void
+BoxArray::compress (const DistributionMapping& dm, int ngrow)
+{
+    BL_PROFILE("BoxArray::compress(dm)");
+
+    uncompress();
+
+    const int N      = size();
+    const int MyProc = ParallelDescriptor::MyProc();
+    //
+    // Rather than build the hash of all the boxes, which pack() would
+    // throw away, hash the grown local boxes and look up every box in it.
+    //
+    BoxList grown_local(ixType());
+
+    for (int i = 0; i < N; ++i)
+	if (dm[i] == MyProc)
+	    grown_local.push_back(BoxLib::grow(get(i),ngrow));
+
+    std::vector<int> local_ids;
+
+    if (grown_local.isNotEmpty())
+    {
+	const BoxArray neighbors(grown_local);
+
+	std::vector< std::pair<int,Box> > isects;
+
+	for (int i = 0; i < N; ++i)
+	{
+	    if (dm[i] == MyProc)
+	    {
+		local_ids.push_back(i);
+	    }
+	    else
+	    {
+		neighbors.intersections(get(i), isects, true, 0);
+
+		if (!isects.empty())
+		    local_ids.push_back(i);
+	    }
+	}
+    }
+
+    m_ref->pack(local_ids);
+}
+
+void
+BoxArray::uncompress ()
+{
+    if (m_ref->packed())
+    {
+#ifdef _OPENMP
+#pragma omp critical(intersections_lock)
+#endif
+	m_ref->unpack();
+    }
 }
 
 void
@@ -1218,7 +1626,9 @@ BoxArray
 BoxLib::complementIn (const Box&      b,
 		      const BoxArray& ba)
 {
-    return BoxArray(BoxLib::complementIn(b,ba.boxList()));
+    BoxList bl(b.ixType());
+    bl.complementIn(b,ba);
+    return BoxArray(bl);
 }
 
 BoxArray
@@ -1291,29 +1701,35 @@ BoxLib::GetBndryCells (const BoxArray& ba,
     //
     // Now strip out intersections with original BoxArray.
     //
-    std::vector< std::pair<int,Box> > isects;
+    const std::vector<Box> gvec(gcells.begin(), gcells.end());
+
+    const int NG = gvec.size();
+
+    std::vector< std::vector<Box> > leftover(NG);
 
-    for (BoxList::const_iterator it = gcells.begin(), End = gcells.end(); it != End; ++it)
+    tba.intersects(tba[0]); // Builds the hash before the parallel region.
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
     {
-        tba.intersections(*it,isects);
+	std::vector< std::pair<int,Box> > isects;
 
-        if (isects.empty())
-        {
-            bcells.push_back(*it);
-        }
-        else
-        {
-            //
-            // Collect all the intersection pieces.
-            //
-            BoxList pieces(btype), leftover(btype);
-            for (int i = 0, N = isects.size(); i < N; i++)
-                pieces.push_back(isects[i].second);
-            leftover = BoxLib::complementIn(*it,pieces);
-            bcells.catenate(leftover);
-        }
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic,64)
+#endif
+	for (int i = 0; i < NG; ++i)
+	{
+	    tba.intersections(gvec[i],isects);
+
+	    BoxLib::complementIn(gvec[i], isects, leftover[i]);
+	}
     }
 
+    for (int i = 0; i < NG; ++i)
+	for (int j = 0, M = leftover[i].size(); j < M; ++j)
+	    bcells.push_back(leftover[i][j]);
+
     //
     // Now strip out overlaps.
     //
@@ -18,12 +18,11 @@
 #include <ParmParse.H>
 #include <MultiFab.H>
 #include <iMultiFab.H>
+#include <sMultiFab.H>
 #include <VisMF.H>
 #endif
 
-#ifdef BL_LAZY
 #include <Lazy.H>
-#endif
 
 #ifdef BL_MEM_PROFILING
 #include <MemProfiler.H>
@@ -373,6 +372,8 @@ BoxLib::Initialize (int& argc, char**& argv, bool build_parm_parse, MPI_Comm mpi
 
     mempool_init();
 
+    BoxLib::InitializeFabArena();
+
     // For thread safety, we should do these initializations here.
     BoxArray::Initialize();
     DistributionMapping::Initialize();
@@ -381,6 +382,7 @@ BoxLib::Initialize (int& argc, char**& argv, bool build_parm_parse, MPI_Comm mpi
     FabArrayBase::Initialize();
     MultiFab::Initialize();
     iMultiFab::Initialize();
+    sMultiFab::Initialize();
     VisMF::Initialize();
 #endif
 
@@ -411,9 +413,7 @@ BoxLib::Finalize (bool finalize_parallel)
 {
     BL_PROFILE_FINALIZE();
 
-#ifdef BL_LAZY
     Lazy::Finalize();
-#endif
 
     while (!The_Finalize_Function_Stack.empty())
     {
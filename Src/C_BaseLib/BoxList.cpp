@@ -328,77 +328,74 @@ BoxList::complementIn (const Box&     b,
     }
     else
     {
-        clear();
+        complementIn(b, BoxArray(bl));
+    }
 
-        Box     mbox = bl.minimalBox();
-        BoxList diff = BoxLib::boxDiff(b,mbox);
+    return *this;
+}
 
-        catenate(diff);
+BoxList&
+BoxList::complementIn (const Box&      b,
+                       const BoxArray& ba)
+{
+    BL_PROFILE("BoxList::complementIn()");
 
-        BoxArray ba(bl);
+    BL_ASSERT(ba.ixType() == b.ixType());
 
-        BoxList mesh(b.ixType());
-        if (mbox.ok())
-            mesh.push_back(mbox);
-        mesh.maxSize(BL_SPACEDIM == 3 ? 64 : 128);
+    clear();
 
-        std::vector< std::pair<int,Box> > isects;
+    btype = b.ixType();
 
-        for (BoxList::const_iterator bli = mesh.begin(), End = mesh.end(); bli != End; ++bli)
-        {
-            const Box& bx = *bli & b;
+    if (ba.empty())
+    {
+	push_back(b);
+	return *this;
+    }
 
-            if (!bx.ok()) continue;
+    Box     mbox = ba.minimalBox();
+    BoxList diff = BoxLib::boxDiff(b,mbox);
 
-            ba.intersections(bx,isects);
+    catenate(diff);
+    //
+    // The pieces of mbox are independent of each other.
+    //
+    BoxList mesh(b.ixType());
+    if (mbox.ok())
+        mesh.push_back(mbox);
+    mesh.maxSize(BL_SPACEDIM == 3 ? 64 : 128);
 
-            if (isects.empty())
-            {
-                push_back(bx);
-            }
-            else
-            {
-                BoxList tm(b.ixType()), tmpbl(b.ixType());
-                for (int i = 0, N = isects.size(); i < N; i++)
-                    tmpbl.push_back(isects[i].second);
-                tm.complementIn_base(bx,tmpbl);
-                catenate(tm);
-            }
-        }
-    }
+    const std::vector<Box> pieces(mesh.begin(), mesh.end());
 
-    return *this;
-}
+    const int N = pieces.size();
 
-BoxList&
-BoxList::complementIn_base (const Box&     b,
-                            const BoxList& bl)
-{
-    BL_ASSERT(bl.ixType() == b.ixType());
+    std::vector< std::vector<Box> > result(N);
 
-    clear();
+    ba.intersects(mbox); // Builds the hash before the parallel region.
 
-    push_back(b);
+#ifdef _OPENMP
+#pragma omp parallel if (N > 1)
+#endif
+    {
+	std::vector< std::pair<int,Box> > isects;
 
-    BoxList diff;
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+	for (int i = 0; i < N; ++i)
+	{
+	    const Box& bx = pieces[i] & b;
 
-    for (const_iterator bli = bl.begin(), End = bl.end(); bli != End && isNotEmpty(); ++bli)
-    {
-        for (iterator newbli = lbox.begin(); newbli != lbox.end(); )
-        {
-            if (newbli->intersects(*bli))
-            {
-                diff = BoxLib::boxDiff(*newbli, *bli);
-                lbox.splice(lbox.begin(), diff.lbox);
-                lbox.erase(newbli++);
-            }
-            else
-            {
-                ++newbli;
-            }
-        }
+	    if (!bx.ok()) continue;
+
+	    ba.intersections(bx,isects);
+
+	    BoxLib::complementIn(bx, isects, result[i]);
+	}
     }
 
+    for (int i = 0; i < N; ++i)
+	lbox.insert(lbox.end(), result[i].begin(), result[i].end());
+
     return *this;
 }
 
@@ -494,6 +491,79 @@ BoxList::shiftHalf (const IntVect& iv)
     return *this;
 }
 
+namespace
+{
+    //
+    // boxDiff() appending to a vector.
+    //
+    void
+    box_diff (const Box& b1in, const Box& b2, std::vector<Box>& out)
+    {
+	if (b2.contains(b1in)) return;
+
+	if (!b1in.intersects(b2))
+	{
+	    out.push_back(b1in);
+	    return;
+	}
+
+	Box b1(b1in);
+
+	const int* b2lo = b2.loVect();
+	const int* b2hi = b2.hiVect();
+
+	for (int i = BL_SPACEDIM-1; i >= 0; i--)
+	{
+	    const int* b1lo = b1.loVect();
+	    const int* b1hi = b1.hiVect();
+
+	    if ((b1lo[i] < b2lo[i]) && (b2lo[i] <= b1hi[i]))
+	    {
+		Box bn(b1);
+		bn.setSmall(i,b1lo[i]);
+		bn.setBig(i,b2lo[i]-1);
+		out.push_back(bn);
+		b1.setSmall(i,b2lo[i]);
+	    }
+	    if ((b1lo[i] <= b2hi[i]) && (b2hi[i] < b1hi[i]))
+	    {
+		Box bn(b1);
+		bn.setSmall(i,b2hi[i]+1);
+		bn.setBig(i,b1hi[i]);
+		out.push_back(bn);
+		b1.setBig(i,b2hi[i]);
+	    }
+	}
+    }
+}
+
+void
+BoxLib::complementIn (const Box&                               b,
+                      const std::vector< std::pair<int,Box> >& isects,
+                      std::vector<Box>&                        result)
+{
+    std::vector<Box> cur(1,b), nxt;
+
+    for (int k = 0, N = isects.size(); k < N && !cur.empty(); ++k)
+    {
+	const Box& cut = isects[k].second;
+
+	nxt.clear();
+
+	for (int j = 0, M = cur.size(); j < M; ++j)
+	{
+	    if (cur[j].intersects(cut))
+		box_diff(cur[j], cut, nxt);
+	    else
+		nxt.push_back(cur[j]);
+	}
+
+	cur.swap(nxt);
+    }
+
+    result.insert(result.end(), cur.begin(), cur.end());
+}
+
 //
 // Returns a list of boxes defining the compliment of b2 in b1in.
 //
@@ -560,38 +630,60 @@ namespace
 int
 BoxList::simplify (bool best)
 {
-    lbox.sort(BoxCmp());
+    std::vector<Box> v(lbox.begin(), lbox.end());
+
+    std::stable_sort(v.begin(), v.end(), BoxCmp());
+
+    std::vector<int> next;
 
-    return simplify_doit(best);
+    const int count = simplify_doit(v, next, best);
+
+    lbox.clear();
+
+    for (int a = next.back(), N = v.size(); a != N; a = next[a])
+	lbox.push_back(v[a]);
+
+    return count;
 }
 
+//
+// The boxes are kept in a vector with next[] linking the ones still in
+// the list, so that merging does no allocation.  next[N] is the head.
+//
 int
-BoxList::simplify_doit (bool best)
+BoxList::simplify_doit (std::vector<Box>& v, std::vector<int>& next, bool best)
 {
+    const int N = v.size();
+
+    next.resize(N+1);
+    for (int i = 0; i < N; ++i)
+	next[i] = i+1;
+    next[N] = 0;
+
+    int& head = next[N];
     //
     // Try to merge adjacent boxes.
     //
     int count = 0, lo[BL_SPACEDIM], hi[BL_SPACEDIM];
 
-    for (iterator bla = begin(), End = end(); bla != End; )
+    for (int bla = head, prev = -1; bla != N; )
     {
-        const int* alo   = bla->loVect();
-        const int* ahi   = bla->hiVect();
+        const int* alo   = v[bla].loVect();
+        const int* ahi   = v[bla].hiVect();
         bool       match = false;
-        iterator   blb   = bla;
-        ++blb;
+        int        blb   = next[bla];
         //
         // If we're not looking for the "best" we can do in one pass, we
         // limit how far afield we look for abutting boxes.  This greatly
         // speeds up this routine for large numbers of boxes.  It does not
         // do quite as good a job though as full brute force.
         //
-        const int MaxCnt = (best ? size() : 100);
+        const int MaxCnt = (best ? N-count : 100);
 
-        for (int cnt = 0; blb != End && cnt < MaxCnt; cnt++)
+        for (int cnt = 0; blb != N && cnt < MaxCnt; cnt++)
         {
-            const int* blo = blb->loVect();
-            const int* bhi = blb->hiVect();
+            const int* blo = v[blb].loVect();
+            const int* bhi = v[blb].hiVect();
             //
             // Determine if a and b can be coalesced.
             // They must have equal extents in all index directions
@@ -629,9 +721,13 @@ BoxList::simplify_doit (bool best)
                 //
                 // Modify b and remove a from the list.
                 //
-                blb->setSmall(IntVect(lo));
-                blb->setBig(IntVect(hi));
-                lbox.erase(bla++);
+                v[blb].setSmall(IntVect(lo));
+                v[blb].setBig(IntVect(hi));
+		if (prev < 0)
+		    head = next[bla];
+		else
+		    next[prev] = next[bla];
+		bla = next[bla];
                 count++;
                 match = true;
                 break;
@@ -641,14 +737,17 @@ BoxList::simplify_doit (bool best)
                 //
                 // No match found, try next element.
                 //
-                ++blb;
+                blb = next[blb];
             }
         }
         //
         // If a match was found, a was already advanced in the list.
         //
         if (!match)
-            ++bla;
+	{
+	    prev = bla;
+            bla  = next[bla];
+	}
     }
     return count;
 }
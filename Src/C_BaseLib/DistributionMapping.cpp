@@ -25,6 +25,7 @@
 #include <string>
 #include <cstring>
 #include <iomanip>
+#include <cmath>
 using std::string;
 
 namespace
@@ -47,6 +48,7 @@ namespace
     int    sfc_threshold;
     Real   max_efficiency;
     int    node_size;
+    Real   node_tolerance;
 }
 
 // We default to SFC.
@@ -59,6 +61,8 @@ Real DistributionMapping::bytesPerCell(0.0);
 Array<int> DistributionMapping::proximityMap;
 Array<int> DistributionMapping::proximityOrder;
 Array<long> DistributionMapping::totalBoxPoints;
+Array<int> DistributionMapping::nodeOfRank;
+Array< Array<int> > DistributionMapping::nodeRanks;
 
 int DistributionMapping::nDistMaps(0);
 
@@ -103,6 +107,9 @@ DistributionMapping::strategy (DistributionMapping::Strategy how)
     case RRSFC:
         m_BuildMap = &DistributionMapping::RRSFCProcessorMap;
         break;
+    case NODESFC:
+        m_BuildMap = &DistributionMapping::NodeSFCProcessorMap;
+        break;
     default:
         BoxLib::Error("Bad DistributionMapping::Strategy");
     }
@@ -143,6 +150,7 @@ DistributionMapping::Initialize ()
     sfc_threshold    = 0;
     max_efficiency   = 0.9;
     node_size        = 0;
+    node_tolerance   = 0.05;
 
     ParmParse pp("DistributionMapping");
 
@@ -151,6 +159,7 @@ DistributionMapping::Initialize ()
     pp.query("efficiency",       max_efficiency);
     pp.query("sfc_threshold",    sfc_threshold);
     pp.query("node_size",        node_size);
+    pp.query("node_tolerance",   node_tolerance);
 
     std::string theStrategy;
 
@@ -177,6 +186,10 @@ DistributionMapping::Initialize ()
         {
             strategy(RRSFC);
         }
+        else if (theStrategy == "NODESFC")
+        {
+            strategy(NODESFC);
+        }
         else
         {
             std::string msg("Unknown strategy: ");
@@ -201,6 +214,8 @@ DistributionMapping::Initialize ()
     }
     totalBoxPoints.resize(ParallelDescriptor::NProcs(), 0);
 
+    DistributionMapping::InitNodeMap(true);
+
     DistributionMapping::nDistMaps = 0;
 
     BoxLib::ExecOnFinalize(DistributionMapping::Finalize);
@@ -218,6 +233,9 @@ DistributionMapping::Finalize ()
     DistributionMapping::m_BuildMap = 0;
 
     DistributionMapping::m_Cache.clear();
+
+    DistributionMapping::nodeOfRank.clear();
+    DistributionMapping::nodeRanks.clear();
 }
 
 //
@@ -1503,6 +1521,390 @@ DistributionMapping::RRSFCProcessorMap (const BoxArray&          boxes,
     RRSFCDoIt(boxes,nprocs);
 }
 
+void
+DistributionMapping::InitNodeMap (bool reinit)
+{
+    const int nprocs = ParallelDescriptor::NProcs();
+
+    if (!reinit && nodeOfRank.size() == nprocs) return;
+
+    BL_PROFILE("DistributionMapping::InitNodeMap()");
+    //
+    // leader[i] is the lowest rank on the node of rank i.
+    //
+    Array<int> leader(nprocs, 0);
+
+#ifdef BL_USE_MPI
+    const int rank = ParallelDescriptor::MyProc();
+
+    int myleader = rank;
+
+#ifdef BL_USE_MPI3
+    MPI_Comm node_comm;
+    BL_MPI_REQUIRE( MPI_Comm_split_type(ParallelDescriptor::Communicator(), MPI_COMM_TYPE_SHARED,
+					rank, MPI_INFO_NULL, &node_comm) );
+    BL_MPI_REQUIRE( MPI_Allreduce(&rank, &myleader, 1, MPI_INT, MPI_MIN, node_comm) );
+    BL_MPI_REQUIRE( MPI_Comm_free(&node_comm) );
+#else
+    char myname[MPI_MAX_PROCESSOR_NAME];
+    std::memset(myname, 0, MPI_MAX_PROCESSOR_NAME);
+    int len;
+    BL_MPI_REQUIRE( MPI_Get_processor_name(myname, &len) );
+
+    Array<char> names(nprocs*MPI_MAX_PROCESSOR_NAME);
+    BL_MPI_REQUIRE( MPI_Allgather(myname, MPI_MAX_PROCESSOR_NAME, MPI_CHAR,
+				  names.dataPtr(), MPI_MAX_PROCESSOR_NAME, MPI_CHAR,
+				  ParallelDescriptor::Communicator()) );
+
+    for (int i = 0; i < rank; ++i)
+    {
+	if (std::strncmp(myname, &names[i*MPI_MAX_PROCESSOR_NAME], MPI_MAX_PROCESSOR_NAME) == 0)
+	{
+	    myleader = i;
+	    break;
+	}
+    }
+#endif
+    BL_MPI_REQUIRE( MPI_Allgather(&myleader, 1, MPI_INT, leader.dataPtr(), 1, MPI_INT,
+				  ParallelDescriptor::Communicator()) );
+#endif
+
+    nodeOfRank.resize(nprocs);
+    nodeRanks.clear();
+
+    std::map<int,int> nodeOfLeader;
+
+    for (int i = 0; i < nprocs; ++i)
+    {
+	std::map<int,int>::const_iterator it = nodeOfLeader.find(leader[i]);
+
+	if (it == nodeOfLeader.end())
+	{
+	    it = nodeOfLeader.insert(std::make_pair(leader[i], int(nodeRanks.size()))).first;
+	    nodeRanks.push_back(Array<int>());
+	}
+
+	nodeOfRank[i] = it->second;
+	nodeRanks[it->second].push_back(i);
+    }
+
+    if (verbose && ParallelDescriptor::IOProcessor())
+    {
+	std::cout << "DistributionMapping: " << nprocs << " processes on "
+		  << nodeRanks.size() << " nodes\n";
+    }
+}
+
+int
+DistributionMapping::NNodes ()
+{
+    BL_ASSERT(nodeOfRank.size() == ParallelDescriptor::NProcs());
+    return nodeRanks.size();
+}
+
+int
+DistributionMapping::NodeOfRank (int rank)
+{
+    BL_ASSERT(nodeOfRank.size() == ParallelDescriptor::NProcs());
+    return nodeOfRank[rank];
+}
+
+const Array<int>&
+DistributionMapping::RanksOnNode (int node)
+{
+    BL_ASSERT(nodeOfRank.size() == ParallelDescriptor::NProcs());
+    return nodeRanks[node];
+}
+
+static
+long
+InterNodeCut (const std::vector<int>&  node,
+	      const std::vector<int>&  adjstart,
+	      const std::vector<int>&  adj,
+	      const std::vector<long>& area)
+{
+    long cut = 0;
+    for (int i = 0, N = node.size(); i < N; ++i)
+	for (int k = adjstart[i]; k < adjstart[i+1]; ++k)
+	    if (node[adj[k]] != node[i])
+		cut += area[k];
+    return cut;
+}
+
+void
+DistributionMapping::NodeSFCDoIt (const BoxArray&          boxes,
+				  const std::vector<long>& wgts,
+				  int                      nprocs)
+{
+    BL_PROFILE("DistributionMapping::NodeSFCDoIt()");
+
+#if defined (BL_USE_TEAM)
+    //
+    // The teams already give us a two-level mapping.
+    //
+    SFCProcessorMapDoIt(boxes,wgts,nprocs);
+    return;
+#endif
+
+    if (ParallelDescriptor::NColors() > 1) 
+	BoxLib::Abort("NodeSFCMap does not support multi colors");
+
+    InitNodeMap();
+
+    const int nnodes = nodeRanks.size();
+
+    if (nnodes == 1 || nnodes == nprocs)
+    {
+	SFCProcessorMapDoIt(boxes,wgts,nprocs);
+	return;
+    }
+
+    std::vector<SFCToken> tokens;
+
+    const int nboxes = boxes.size();
+
+    tokens.reserve(nboxes);
+
+    int maxijk = 0;
+
+    for (int i = 0; i < nboxes; ++i)
+    {
+	const Box& bx = boxes[i];
+        tokens.push_back(SFCToken(i,bx.smallEnd(),wgts[i]));
+
+        const SFCToken& token = tokens.back();
+
+        D_TERM(maxijk = std::max(maxijk, token.m_idx[0]);,
+               maxijk = std::max(maxijk, token.m_idx[1]);,
+               maxijk = std::max(maxijk, token.m_idx[2]););
+    }
+    //
+    // Set SFCToken::MaxPower for BoxArray.
+    //
+    int m = 0;
+    for ( ; (1 << m) <= maxijk; ++m) {
+        ;  // do nothing
+    }
+    SFCToken::MaxPower = m;
+    //
+    // Put'm in Morton space filling curve order.
+    //
+    std::sort(tokens.begin(), tokens.end(), SFCToken::Compare());
+    //
+    // Cut the curve into one segment per node.  Node n gets a share of the
+    // total weight proportional to the number of ranks on it.
+    //
+    Real totalvol = 0;
+    for (int i = 0; i < nboxes; ++i)
+        totalvol += tokens[i].m_vol;
+
+    std::vector<Real> target(nnodes);
+    for (int n = 0; n < nnodes; ++n)
+	target[n] = totalvol*nodeRanks[n].size()/nprocs;
+
+    std::vector<int>  node(nboxes);
+    std::vector<long> load(nnodes, 0);
+
+    Real cumtarget = 0, cumvol = 0;
+
+    for (int n = 0, K = 0; n < nnodes; ++n)
+    {
+	cumtarget += target[n];
+
+	for ( ; K < nboxes && (n == nnodes-1 || cumvol + 0.5*tokens[K].m_vol <= cumtarget); ++K)
+	{
+	    const int i = tokens[K].m_box;
+	    cumvol  += tokens[K].m_vol;
+	    node[i]  = n;
+	    load[n] += wgts[i];
+	}
+    }
+
+    tokens.clear();
+    //
+    // The BoxArray adjacency graph.  The weight of edge (i,j) is the number
+    // of cells of box j in one layer of ghost cells around box i.
+    //
+    std::vector<int>  adjstart(nboxes+1, 0);
+    std::vector<int>  adj;
+    std::vector<long> area;
+
+    std::vector< std::pair<int,Box> > isects;
+
+    for (int i = 0; i < nboxes; ++i)
+    {
+	boxes.intersections(BoxLib::grow(boxes[i],1), isects);
+
+	for (int k = 0, M = isects.size(); k < M; ++k)
+	{
+	    if (isects[k].first != i)
+	    {
+		adj.push_back(isects[k].first);
+		area.push_back(isects[k].second.numPts());
+	    }
+	}
+
+	adjstart[i+1] = adj.size();
+    }
+
+    const long cut_sfc = verbose ? InterNodeCut(node,adjstart,adj,area) : 0;
+    //
+    // Move boxes to the neighbouring node they are most connected to if
+    // that lowers the inter-node face area and keeps both nodes within
+    // node_tolerance of their targets.
+    //
+    std::vector<long> conn(nnodes, 0);
+
+    for (int pass = 0; pass < 4; ++pass)
+    {
+	int nmoved = 0;
+
+	for (int i = 0; i < nboxes; ++i)
+	{
+	    const int  a = node[i];
+	    const long w = wgts[i];
+
+	    for (int k = adjstart[i]; k < adjstart[i+1]; ++k)
+		conn[node[adj[k]]] += area[k];
+
+	    int  b    = -1;
+	    long best = conn[a];
+
+	    if (load[a] - w >= (1-node_tolerance)*target[a])
+	    {
+		for (int k = adjstart[i]; k < adjstart[i+1]; ++k)
+		{
+		    const int n = node[adj[k]];
+
+		    if (n != a && conn[n] > best && load[n] + w <= (1+node_tolerance)*target[n])
+		    {
+			b    = n;
+			best = conn[n];
+		    }
+		}
+	    }
+
+	    if (b >= 0)
+	    {
+		node[i] = b;
+		load[a] -= w;
+		load[b] += w;
+		++nmoved;
+	    }
+
+	    conn[a] = 0;
+	    for (int k = adjstart[i]; k < adjstart[i+1]; ++k)
+		conn[node[adj[k]]] = 0;
+	}
+
+	if (nmoved == 0) break;
+    }
+    //
+    // Knapsack the boxes on each node over its ranks.  The heaviest chunk
+    // goes to the least used rank.
+    //
+    std::vector< std::vector<int> > vec(nnodes);
+
+    for (int i = 0; i < nboxes; ++i)
+	vec[node[i]].push_back(i);
+
+    Array<int> ord;
+
+    LeastUsedCPUs(nprocs,ord);
+
+    std::vector<int> usage(nprocs);
+    for (int i = 0; i < nprocs; ++i)
+	usage[ord[i]] = i;
+
+    long max_wgt = 0;
+
+    for (int n = 0; n < nnodes; ++n)
+    {
+	const std::vector<int>& vi = vec[n];
+	const int Nbx = vi.size();
+
+	if (Nbx == 0) continue;
+
+	std::vector<LIpair> ranks;
+	for (int r = 0, NR = nodeRanks[n].size(); r < NR; ++r)
+	    ranks.push_back(LIpair(usage[nodeRanks[n][r]], nodeRanks[n][r]));
+	Sort(ranks, false);
+
+	const int nworkers = ranks.size();
+
+	std::vector<long> local_wgts;
+	for (int j = 0; j < Nbx; ++j)
+	    local_wgts.push_back(wgts[vi[j]]);
+
+	std::vector<std::vector<int> > kpres;
+	Real kpeff;
+	knapsack(local_wgts, nworkers, kpres, kpeff, true, nboxes+1);
+
+	std::vector<LIpair> ww;
+	for (int w = 0; w < nworkers; ++w)
+	{
+	    long wgt = 0;
+	    for (std::vector<int>::const_iterator it = kpres[w].begin();
+		 it != kpres[w].end(); ++it)
+	    {
+		wgt += local_wgts[*it];
+	    }
+	    ww.push_back(LIpair(wgt,w));
+	    max_wgt = std::max(max_wgt, wgt);
+	}
+	Sort(ww,true);
+
+	for (int w = 0; w < nworkers; ++w)
+	{
+	    const int cpu = ranks[w].second;
+	    const std::vector<int>& js = kpres[ww[w].second];
+	    for (std::vector<int>::const_iterator it = js.begin(); it != js.end(); ++it)
+		m_ref->m_pmap[vi[*it]] = cpu;
+	}
+    }
+    //
+    // Set sentinel equal to our processor number.
+    //
+    m_ref->m_pmap[nboxes] = ParallelDescriptor::MyProc();
+
+    if (verbose && ParallelDescriptor::IOProcessor())
+    {
+        std::cout << "NODESFC: inter-node ghost cells: " << cut_sfc << " (SFC) -> "
+		  << InterNodeCut(node,adjstart,adj,area)
+		  << ", efficiency: " << (totalvol/(nprocs*Real(max_wgt))) << '\n';
+    }
+}
+
+void
+DistributionMapping::NodeSFCProcessorMap (const BoxArray& boxes,
+					  int             nprocs)
+{
+    BL_ASSERT(boxes.size() > 0);
+
+    if (m_ref->m_pmap.size() != boxes.size() + 1)
+    {
+        m_ref->m_pmap.resize(boxes.size()+1);
+    }
+
+    if (boxes.size() < sfc_threshold*nprocs)
+    {
+        KnapSackProcessorMap(boxes,nprocs);
+    }
+    else
+    {
+        std::vector<long> wgts;
+
+        wgts.reserve(boxes.size());
+
+	for (int i = 0, N = boxes.size(); i < N; ++i)
+        {
+            wgts.push_back(boxes[i].volume());
+        }
+
+        NodeSFCDoIt(boxes,wgts,nprocs);
+    }
+}
+
 namespace
 {
     struct PFCToken
@@ -2877,15 +3279,17 @@ DistributionMapping::TranslateProcMap(const Array<int> &pm_old, const MPI_Group
 #endif
 
 
-DistributionMapping
-DistributionMapping::makeKnapSack (const MultiFab& weight)
+namespace
 {
-    DistributionMapping r;
-
-    Array<long> cost(weight.size());
-#if BL_USE_MPI
+    //
+    // The sum of weight over each valid box, on all processes.
+    //
+    void
+    BoxCosts (const MultiFab& weight, Array<Real>& rcost)
     {
-	Array<Real> rcost(cost.size(), 0.0);
+	rcost.resize(weight.size());
+	for (int i = 0; i < rcost.size(); ++i)
+	    rcost[i] = 0;
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -2895,15 +3299,33 @@ DistributionMapping::makeKnapSack (const MultiFab& weight)
 	}
 
 	ParallelDescriptor::ReduceRealSum(&rcost[0], rcost.size());
-
+    }
+    //
+    // The integer weights used by the mapping algorithms.  The largest is 1.e9.
+    //
+    void
+    ScaleCosts (const Array<Real>& rcost, std::vector<long>& cost)
+    {
 	Real wmax = *std::max_element(rcost.begin(), rcost.end());
-	Real scale = 1.e9/wmax;
-	
+	Real scale = (wmax > 0) ? 1.e9/wmax : 1.0;
+
+	cost.resize(rcost.size());
 	for (int i = 0; i < rcost.size(); ++i) {
-	    cost[i] = long(cost[i]*scale) + 1L;
+	    cost[i] = long(rcost[i]*scale) + 1L;
 	}
     }
-#endif
+}
+
+DistributionMapping
+DistributionMapping::makeKnapSack (const MultiFab& weight)
+{
+    DistributionMapping r;
+
+    Array<Real> rcost;
+    BoxCosts(weight, rcost);
+
+    std::vector<long> cost;
+    ScaleCosts(rcost, cost);
 
     int nprocs = ParallelDescriptor::NProcs();
     Real eff;
@@ -2913,6 +3335,120 @@ DistributionMapping::makeKnapSack (const MultiFab& weight)
     return r;
 }
 
+DistributionMapping
+DistributionMapping::makeSFC (const MultiFab& weight)
+{
+    Array<Real> rcost;
+    BoxCosts(weight, rcost);
+
+    return makeSFC(rcost, weight.boxArray());
+}
+
+DistributionMapping
+DistributionMapping::makeSFC (const Array<Real>& rcost, const BoxArray& boxes)
+{
+    BL_ASSERT(rcost.size() == boxes.size());
+
+    DistributionMapping r;
+
+    std::vector<long> cost;
+    ScaleCosts(rcost, cost);
+
+    r.SFCProcessorMap(boxes, cost, ParallelDescriptor::NProcs());
+
+    return r;
+}
+
+bool
+DistributionMapping::Rebalance (const Array<Real>&         rcost,
+				const DistributionMapping& current,
+				Real                       threshold,
+				Array<int>&                newmap)
+{
+    BL_PROFILE("DistributionMapping::Rebalance()");
+
+    const int nprocs = ParallelDescriptor::NProcs();
+    const int N      = rcost.size();
+
+    BL_ASSERT(current.size() == N+1);
+
+    newmap = current.ProcessorMap();
+
+    if (nprocs < 2 || N == 0) return false;
+
+    std::vector<Real> load(nprocs, 0.0);
+    std::vector< std::vector<int> > boxes(nprocs);
+
+    Real total = 0;
+    for (int i = 0; i < N; ++i) {
+	load[newmap[i]] += rcost[i];
+	boxes[newmap[i]].push_back(i);
+	total += rcost[i];
+    }
+
+    const Real avg = total/nprocs;
+
+    if (avg <= 0) return false;
+
+    const Real imbalance_0 = *std::max_element(load.begin(), load.end()) / avg;
+
+    if (imbalance_0 <= threshold) return false;
+    //
+    // Move one box at a time from the most to the least loaded process.
+    // The box that best evens out the two is picked.  This stops as soon
+    // as the most loaded process is within threshold, or no box fits in
+    // the gap between the two, but after no more than N moves.
+    //
+    for (int iter = 0; iter < N; ++iter)
+    {
+	const int pmax = std::max_element(load.begin(), load.end()) - load.begin();
+	const int pmin = std::min_element(load.begin(), load.end()) - load.begin();
+
+	if (load[pmax] <= threshold*avg) break;
+
+	const Real gap = load[pmax] - load[pmin];
+
+	std::vector<int>& bmax = boxes[pmax];
+
+	int  jbest = -1;
+	Real dbest = gap/2;
+	for (int j = 0, M = bmax.size(); j < M; ++j) {
+	    const Real c = rcost[bmax[j]];
+	    if (c > 0 && c < gap && std::abs(c - gap/2) < dbest) {
+		jbest = j;
+		dbest = std::abs(c - gap/2);
+	    }
+	}
+
+	if (jbest < 0) break;
+
+	const int ibox = bmax[jbest];
+
+	load[pmax] -= rcost[ibox];
+	load[pmin] += rcost[ibox];
+	bmax[jbest] = bmax.back();
+	bmax.pop_back();
+	boxes[pmin].push_back(ibox);
+	newmap[ibox] = pmin;
+    }
+
+    int nmoved = 0;
+    for (int i = 0; i < N; ++i) {
+	if (newmap[i] != current[i]) ++nmoved;
+    }
+
+    const Real imbalance_1 = *std::max_element(load.begin(), load.end()) / avg;
+
+    if (verbose && ParallelDescriptor::IOProcessor())
+    {
+	std::cout << "DistributionMapping::Rebalance: imbalance " << imbalance_0
+		  << " -> " << imbalance_1 << " moving " << nmoved << " of "
+		  << N << " boxes\n";
+    }
+
+    return nmoved > 0;
+}
+
 std::ostream&
 operator<< (std::ostream&              os,
             const DistributionMapping& pmap)
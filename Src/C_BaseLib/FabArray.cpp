@@ -16,10 +16,17 @@
 #include <MemProfiler.H>
 #endif
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 //
 // Set default values in Initialize()!!!
 //
 bool    FabArrayBase::do_async_sends;
+bool    FabArrayBase::use_persistent_comm;
+bool    FabArrayBase::use_neighbor_collective;
+bool    FabArrayBase::numa_first_touch;
 int     FabArrayBase::MaxComp;
 #if BL_SPACEDIM == 1
 IntVect FabArrayBase::mfiter_tile_size(1024000);
@@ -47,9 +54,18 @@ std::map<FabArrayBase::BDKey, int> FabArrayBase::m_BD_count;
 
 FabArrayBase::FabArrayStats        FabArrayBase::m_FA_stats;
 
+std::map<std::string,FabArrayBase::CompressStats> FabArrayBase::m_CC_stats;
+
 namespace
 {
     bool initialized = false;
+    //
+    // Persistent requests are bound to this communicator with a fixed tag.
+    // Messages are matched in the order they are started, which is the
+    // same on all processes.
+    //
+    MPI_Comm persistent_comm = MPI_COMM_NULL;
+    const int persistent_tag = 0;
 }
 
 
@@ -75,6 +91,9 @@ FabArrayBase::Initialize ()
     // Set default values here!!!
     //
     FabArrayBase::do_async_sends    = true;
+    FabArrayBase::use_persistent_comm = false;
+    FabArrayBase::use_neighbor_collective = false;
+    FabArrayBase::numa_first_touch  = false;
     FabArrayBase::MaxComp           = 25;
 
     ParmParse pp("fabarray");
@@ -98,12 +117,29 @@ FabArrayBase::Initialize ()
 
     pp.query("maxcomp",             FabArrayBase::MaxComp);
     pp.query("do_async_sends",      FabArrayBase::do_async_sends);
+    pp.query("use_persistent_comm", FabArrayBase::use_persistent_comm);
+    pp.query("use_neighbor_collective", FabArrayBase::use_neighbor_collective);
+    pp.query("numa_first_touch",    FabArrayBase::numa_first_touch);
+
+#if !defined(BL_USE_MPI3) || defined(BL_USE_UPCXX)
+    if (FabArrayBase::use_neighbor_collective) {
+	if (ParallelDescriptor::IOProcessor())
+	    std::cout << "fabarray.use_neighbor_collective ignored: needs USE_MPI3=TRUE\n";
+	FabArrayBase::use_neighbor_collective = false;
+    }
+#endif
 
     if (MaxComp < 1)
         MaxComp = 1;
 
     FabArrayBase::nFabArrays = 0;
 
+#ifdef BL_USE_MPI
+    if (FabArrayBase::use_persistent_comm && ParallelDescriptor::NProcs() > 1) {
+	BL_MPI_REQUIRE( MPI_Comm_dup(ParallelDescriptor::Communicator(), &persistent_comm) );
+    }
+#endif
+
     BoxLib::ExecOnFinalize(FabArrayBase::Finalize);
 
 #ifdef BL_MEM_PROFILING
@@ -127,6 +163,9 @@ FabArrayBase::Initialize ()
 }
 
 FabArrayBase::FabArrayBase ()
+    :
+    comm_codec(NOCOMPRESS),
+    comm_keep(0)
 {
     aFAPId = nFabArrays++;
     aFAPIdLock = 0;  // ---- not locked
@@ -151,6 +190,99 @@ FabArrayBase::bytesOfMapOfCopyComTagContainers (const FabArrayBase::MapOfCopyCom
     return r;
 }
 
+namespace
+{
+    //
+    // Cuts the items, with cells[i] cells each, into nchunks contiguous
+    // chunks with about the same number of cells.
+    //
+    void
+    CutIntoChunks (const Array<long>& cells, int nchunks, Array<int>& chunk)
+    {
+	const int  N     = cells.size();
+	const long total = std::accumulate(cells.begin(), cells.end(), 0L);
+
+	chunk.resize(nchunks+1);
+	chunk[0] = 0;
+
+	long sum = 0;
+	int  i   = 0;
+	for (int c = 1; c < nchunks; ++c)
+	{
+	    const long target = (total*c)/nchunks;
+	    //
+	    // An item goes into this chunk if most of it comes before the target.
+	    //
+	    while (i < N && 2*sum + cells[i] <= 2*target) {
+		sum += cells[i];
+		++i;
+	    }
+	    chunk[c] = i;
+	}
+	chunk[nchunks] = N;
+    }
+
+    void
+    FlattenTags (const FabArrayBase::MapOfCopyComTagContainers& Tags,
+		 Array<FabArrayBase::CommChunks::Item>&         items,
+		 Array<long>&                                   cells)
+    {
+	int msg = 0;
+	for (FabArrayBase::MapOfCopyComTagContainers::const_iterator m_it = Tags.begin(),
+		 m_End = Tags.end(); m_it != m_End; ++m_it, ++msg)
+	{
+	    long offset = 0;
+	    for (FabArrayBase::CopyComTagsContainer::const_iterator it = m_it->second.begin(),
+		     End = m_it->second.end(); it != End; ++it)
+	    {
+		const long n = it->sbox.numPts();
+		items.push_back(FabArrayBase::CommChunks::Item(&(*it), msg, offset));
+		cells.push_back(n);
+		offset += n;
+	    }
+	}
+    }
+}
+
+void
+FabArrayBase::CommChunks::define (const CopyComTagsContainer&      LocTags,
+				  const MapOfCopyComTagContainers& SndTags,
+				  const MapOfCopyComTagContainers& RcvTags)
+{
+#ifdef _OPENMP
+    const int nchunks = omp_get_max_threads();
+#else
+    const int nchunks = 1;
+#endif
+
+    m_snd_items.clear();
+    m_rcv_items.clear();
+
+    Array<long> cells;
+
+    FlattenTags(SndTags, m_snd_items, cells);
+    CutIntoChunks(cells, nchunks, m_snd);
+
+    cells.clear();
+    FlattenTags(RcvTags, m_rcv_items, cells);
+    CutIntoChunks(cells, nchunks, m_rcv);
+
+    cells.clear();
+    for (CopyComTagsContainer::const_iterator it = LocTags.begin(), End = LocTags.end();
+	 it != End; ++it)
+    {
+	cells.push_back(it->sbox.numPts());
+    }
+    CutIntoChunks(cells, nchunks, m_loc);
+}
+
+long
+FabArrayBase::CommChunks::bytes () const
+{
+    return BoxLib::bytesOf(m_snd_items) + BoxLib::bytesOf(m_rcv_items)
+	+  BoxLib::bytesOf(m_snd) + BoxLib::bytesOf(m_rcv) + BoxLib::bytesOf(m_loc);
+}
+
 long
 FabArrayBase::CPC::bytes () const
 {
@@ -171,6 +303,8 @@ FabArrayBase::CPC::bytes () const
     if (m_RcvVols)
 	cnt += BoxLib::bytesOf(*m_RcvVols);
 
+    cnt += m_chunks.bytes();
+
     return cnt;
 }
 
@@ -194,6 +328,14 @@ FabArrayBase::FB::bytes () const
     if (m_RcvVols)
 	cnt += BoxLib::bytesOf(*m_RcvVols);
 
+    cnt += m_chunks.bytes();
+
+    for (std::map<int, std::vector< std::pair<Box,int> > >::const_iterator it = m_RcvBoxes.begin(),
+	     End = m_RcvBoxes.end(); it != End; ++it)
+    {
+	cnt += sizeof(*it) + it->second.capacity()*sizeof(std::pair<Box,int>);
+    }
+
     return cnt;
 }
 
@@ -225,6 +367,7 @@ FabArrayBase::CPC::CPC (const FabArrayBase& dstfa, int dstng,
 {
     this->define(m_dstba, dstfa.DistributionMap(), dstfa.IndexArray(), 
 		 m_srcba, srcfa.DistributionMap(), srcfa.IndexArray());
+    m_chunks.define(*m_LocTags, *m_SndTags, *m_RcvTags);
 }
 
 FabArrayBase::CPC::CPC (const BoxArray& dstba, const DistributionMapping& dstdm, 
@@ -243,10 +386,12 @@ FabArrayBase::CPC::CPC (const BoxArray& dstba, const DistributionMapping& dstdm,
       m_LocTags(0), m_SndTags(0), m_RcvTags(0), m_SndVols(0), m_RcvVols(0), m_nuse(0)
 {
     this->define(dstba, dstdm, dstidx, srcba, srcdm, srcidx, myproc);
+    m_chunks.define(*m_LocTags, *m_SndTags, *m_RcvTags);
 }
 
 FabArrayBase::CPC::~CPC ()
 {
+    FabArrayBase::FreePersistentComms(m_pcomms);
     delete m_LocTags;
     delete m_SndTags;
     delete m_RcvTags;
@@ -547,7 +692,8 @@ FabArrayBase::FB::FB (const FabArrayBase& fa, bool cross, const Periodicity& per
       m_RcvTags(new CopyComTag::MapOfCopyComTagContainers),
       m_SndVols(new std::map<int,int>),
       m_RcvVols(new std::map<int,int>),
-      m_nuse(0)
+      m_nuse(0),
+      m_nbr_comm(MPI_COMM_NULL)
 {
     BL_PROFILE("FabArrayBase::FB::FB()");
 
@@ -559,6 +705,19 @@ FabArrayBase::FB::FB (const FabArrayBase& fa, bool cross, const Periodicity& per
 	    define_fb(fa);
 	}
     }
+
+    m_chunks.define(*m_LocTags, *m_SndTags, *m_RcvTags);
+
+    int k = 0;
+    for (MapOfCopyComTagContainers::const_iterator m_it = m_RcvTags->begin(),
+	     m_End = m_RcvTags->end(); m_it != m_End; ++m_it, ++k)
+    {
+	for (CopyComTagsContainer::const_iterator it = m_it->second.begin(),
+		 End = m_it->second.end(); it != End; ++it)
+	{
+	    m_RcvBoxes[it->dstIndex].push_back(std::make_pair(it->dbox, k));
+	}
+    }
 }
 
 void
@@ -968,6 +1127,11 @@ FabArrayBase::FB::define_epo (const FabArrayBase& fa)
 
 FabArrayBase::FB::~FB ()
 {
+    FabArrayBase::FreePersistentComms(m_pcomms);
+#if defined(BL_USE_MPI3) && !defined(BL_USE_UPCXX)
+    if (m_nbr_comm != MPI_COMM_NULL)
+	BL_MPI_REQUIRE( MPI_Comm_free(&m_nbr_comm) );
+#endif
     delete m_LocTags;
     delete m_SndTags;
     delete m_RcvTags;
@@ -975,6 +1139,287 @@ FabArrayBase::FB::~FB ()
     delete m_RcvVols;
 }
 
+MPI_Comm
+FabArrayBase::FB::NeighborComm () const
+{
+#if defined(BL_USE_MPI3) && !defined(BL_USE_UPCXX)
+    if (m_nbr_comm == MPI_COMM_NULL)
+    {
+	BL_PROFILE("FabArrayBase::FB::NeighborComm()");
+
+	Array<int> sources, destinations;
+
+	for (std::map<int,int>::const_iterator it = m_RcvVols->begin(), End = m_RcvVols->end();
+	     it != End; ++it)
+	{
+	    sources.push_back(it->first);
+	}
+	for (std::map<int,int>::const_iterator it = m_SndVols->begin(), End = m_SndVols->end();
+	     it != End; ++it)
+	{
+	    destinations.push_back(it->first);
+	}
+	//
+	// No reordering.  The ranks have to match those in the tags.
+	//
+	int dummy;
+	BL_MPI_REQUIRE( MPI_Dist_graph_create_adjacent(ParallelDescriptor::Communicator(),
+						       sources.size(),
+						       sources.empty() ? &dummy : sources.dataPtr(),
+						       MPI_UNWEIGHTED,
+						       destinations.size(),
+						       destinations.empty() ? &dummy : destinations.dataPtr(),
+						       MPI_UNWEIGHTED,
+						       MPI_INFO_NULL, 0, &m_nbr_comm) );
+    }
+#endif
+    return m_nbr_comm;
+}
+
+FabArrayBase::PersistentComm::PersistentComm (const std::map<int,int>& SndVols,
+					      const std::map<int,int>& RcvVols,
+					      int                      ncomp,
+					      int                      szvalue)
+    :
+    m_ncomp(ncomp),
+    m_szvalue(szvalue),
+    m_inuse(false),
+    m_the_recv_data(0),
+    m_the_send_data(0)
+{
+#ifdef BL_USE_MPI
+    BL_ASSERT(persistent_comm != MPI_COMM_NULL);
+
+    long TotalRcvsBytes = 0, TotalSndsBytes = 0;
+
+    for (std::map<int,int>::const_iterator it = RcvVols.begin(), End = RcvVols.end();
+	 it != End; ++it)
+    {
+	TotalRcvsBytes += long(it->second)*ncomp*szvalue;
+    }
+    for (std::map<int,int>::const_iterator it = SndVols.begin(), End = SndVols.end();
+	 it != End; ++it)
+    {
+	TotalSndsBytes += long(it->second)*ncomp*szvalue;
+    }
+
+    if (TotalRcvsBytes > 0)
+	m_the_recv_data = static_cast<char*>(BoxLib::The_Arena()->alloc(TotalRcvsBytes));
+    if (TotalSndsBytes > 0)
+	m_the_send_data = static_cast<char*>(BoxLib::The_Arena()->alloc(TotalSndsBytes));
+
+    long Offset = 0;
+
+    for (std::map<int,int>::const_iterator it = RcvVols.begin(), End = RcvVols.end();
+	 it != End; ++it)
+    {
+	const long N = long(it->second)*ncomp*szvalue;
+
+	BL_ASSERT(N < std::numeric_limits<int>::max());
+
+	MPI_Request req;
+	BL_MPI_REQUIRE( MPI_Recv_init(m_the_recv_data+Offset, N, MPI_CHAR, it->first,
+				      persistent_tag, persistent_comm, &req) );
+
+	m_recv_data.push_back(m_the_recv_data+Offset);
+	m_recv_from.push_back(it->first);
+	m_recv_reqs.push_back(req);
+
+	Offset += N;
+    }
+
+    Offset = 0;
+
+    for (std::map<int,int>::const_iterator it = SndVols.begin(), End = SndVols.end();
+	 it != End; ++it)
+    {
+	const long N = long(it->second)*ncomp*szvalue;
+
+	BL_ASSERT(N < std::numeric_limits<int>::max());
+
+	MPI_Request req;
+	BL_MPI_REQUIRE( MPI_Send_init(m_the_send_data+Offset, N, MPI_CHAR, it->first,
+				      persistent_tag, persistent_comm, &req) );
+
+	m_send_data.push_back(m_the_send_data+Offset);
+	m_send_rank.push_back(it->first);
+	m_send_reqs.push_back(req);
+
+	Offset += N;
+    }
+#endif
+}
+
+FabArrayBase::PersistentComm::~PersistentComm ()
+{
+    BL_ASSERT(!m_inuse);
+#ifdef BL_USE_MPI
+    for (int i = 0, N = m_recv_reqs.size(); i < N; ++i)
+	BL_MPI_REQUIRE( MPI_Request_free(&m_recv_reqs[i]) );
+    for (int i = 0, N = m_send_reqs.size(); i < N; ++i)
+	BL_MPI_REQUIRE( MPI_Request_free(&m_send_reqs[i]) );
+#endif
+    if (m_the_recv_data) BoxLib::The_Arena()->free(m_the_recv_data);
+    if (m_the_send_data) BoxLib::The_Arena()->free(m_the_send_data);
+}
+
+FabArrayBase::PersistentComm*
+FabArrayBase::getPersistentComm (PersistentComms&         pcs,
+				 const std::map<int,int>& SndVols,
+				 const std::map<int,int>& RcvVols,
+				 int                      ncomp,
+				 int                      szvalue)
+{
+    //
+    // A cached pattern may be in flight for more than one FabArray at a
+    // time, e.g., with FillBoundary_nowait().  Each needs its own buffers.
+    //
+    for (PersistentComms::iterator it = pcs.begin(), End = pcs.end(); it != End; ++it)
+    {
+	PersistentComm* pc = *it;
+	if (!pc->m_inuse && pc->m_ncomp == ncomp && pc->m_szvalue == szvalue) {
+	    pc->m_inuse = true;
+	    return pc;
+	}
+    }
+    PersistentComm* pc = new PersistentComm(SndVols, RcvVols, ncomp, szvalue);
+    pc->m_inuse = true;
+    pcs.push_back(pc);
+    return pc;
+}
+
+void
+FabArrayBase::setCommCompression (CommCodec          codec,
+				  int                keep,
+				  const std::string& tag)
+{
+    BL_ASSERT(codec != TRUNCATE || keep >= 1);
+
+    comm_codec = codec;
+    comm_keep  = keep;
+    comm_tag   = tag;
+    //
+    // Make the entry now so that all processes have the same tags.
+    //
+    if (codec != NOCOMPRESS)
+	m_CC_stats[tag];
+}
+
+void
+FabArrayBase::CompressMsgs (const Array<char*>& raw,
+			    const Array<int>&   nvalues,
+			    int                 szvalue,
+			    Array<char*>&       msg,
+			    Array<int>&         msg_bytes) const
+{
+    BL_PROFILE("FabArray::CompressMsgs()");
+
+    const double strt = ParallelDescriptor::second();
+
+    const int N    = raw.size();
+    const int keep = commKeep(szvalue);
+
+    msg      .resize(N);
+    msg_bytes.resize(N);
+
+    for (int i = 0; i < N; ++i) {
+	msg[i] = static_cast<char*>
+	    (BoxLib::The_Arena()->alloc(BLCompress::MaxCompressedSize(nvalues[i],keep)));
+    }
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < N; ++i) {
+	msg_bytes[i] = BLCompress::Compress(raw[i], nvalues[i], szvalue, keep, msg[i]);
+    }
+
+    long nraw = 0, nmsg = 0;
+    for (int i = 0; i < N; ++i) {
+	nraw += long(nvalues[i])*szvalue;
+	nmsg += msg_bytes[i];
+    }
+
+    const double stop = ParallelDescriptor::second();
+
+#ifdef _OPENMP
+#pragma omp critical(fabarray_compress_stats)
+#endif
+    {
+	CompressStats& cs = m_CC_stats[comm_tag];
+	cs.nmsgs         += N;
+	cs.raw_bytes     += nraw;
+	cs.msg_bytes     += nmsg;
+	cs.compress_time += stop - strt;
+    }
+}
+
+void
+FabArrayBase::DecompressMsgs (const Array<char*>& msg,
+			      const Array<char*>& raw,
+			      const Array<int>&   nvalues,
+			      int                 szvalue,
+			      const Array<int>&   which) const
+{
+    BL_PROFILE("FabArray::DecompressMsgs()");
+
+    const double strt = ParallelDescriptor::second();
+
+    const int N    = which.size();
+    const int keep = commKeep(szvalue);
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < N; ++i) {
+	const int k = which[i];
+	//
+	// The receive buffers have room for the largest message.
+	//
+	BLCompress::Decompress(msg[k], BLCompress::MaxCompressedSize(nvalues[k],keep),
+			       raw[k], nvalues[k], szvalue);
+    }
+
+    const double stop = ParallelDescriptor::second();
+
+#ifdef _OPENMP
+#pragma omp critical(fabarray_compress_stats)
+#endif
+    {
+	m_CC_stats[comm_tag].decompress_time += stop - strt;
+    }
+}
+
+bool
+FabArrayBase::PersistentCommOK (ParallelDescriptor::Color color)
+{
+    //
+    // persistent_comm is a copy of the communicator we started with.
+    // It can't be used once sidecars have split that up.
+    //
+    return persistent_comm != MPI_COMM_NULL
+	&& ParallelDescriptor::nSidecars == 0
+	&& color == ParallelDescriptor::DefaultColor()
+	&& !ParallelDescriptor::MPIOneSided();
+}
+
+bool
+FabArrayBase::NeighborCollectiveOK (ParallelDescriptor::Color color)
+{
+    return FabArrayBase::use_neighbor_collective
+	&& ParallelDescriptor::nSidecars == 0
+	&& color == ParallelDescriptor::DefaultColor()
+	&& !ParallelDescriptor::MPIOneSided();
+}
+
+void
+FabArrayBase::FreePersistentComms (PersistentComms& pcs)
+{
+    for (PersistentComms::iterator it = pcs.begin(), End = pcs.end(); it != End; ++it)
+	delete *it;
+    pcs.clear();
+}
+
 void
 FabArrayBase::flushFB (bool no_assertion) const
 {
@@ -1214,14 +1659,54 @@ FabArrayBase::Finalize ()
 
     FabArrayBase::flushTileArrayCache();
 
+#ifdef BL_USE_MPI
+    if (persistent_comm != MPI_COMM_NULL) {
+	BL_MPI_REQUIRE( MPI_Comm_free(&persistent_comm) );
+	persistent_comm = MPI_COMM_NULL;
+    }
+#endif
+
+    //
+    // The tags are the same on all processes; see setCommCompression().
+    //
+    for (std::map<std::string,CompressStats>::iterator it = m_CC_stats.begin(),
+	     End = m_CC_stats.end(); BoxLib::verbose && it != End; ++it)
+    {
+	CompressStats& cs = it->second;
+	long cnt[3] = { cs.nmsgs, cs.raw_bytes, cs.msg_bytes };
+	ParallelDescriptor::ReduceLongSum(cnt, 3);
+	ParallelDescriptor::ReduceRealMax(cs.compress_time);
+	ParallelDescriptor::ReduceRealMax(cs.decompress_time);
+	cs.nmsgs     = cnt[0];
+	cs.raw_bytes = cnt[1];
+	cs.msg_bytes = cnt[2];
+    }
+
     if (ParallelDescriptor::IOProcessor() && BoxLib::verbose) {
 	m_FA_stats.print();
 	m_TAC_stats.print();
 	m_FBC_stats.print();
 	m_CPC_stats.print();
 	m_FPinfo_stats.print();
+
+	for (std::map<std::string,CompressStats>::const_iterator it = m_CC_stats.begin(),
+		 End = m_CC_stats.end(); it != End; ++it)
+	{
+	    const CompressStats& cs = it->second;
+	    std::cout << "### Message compression: " << it->first << " ###\n";
+	    std::cout << "    tot # of messages    : " << cs.nmsgs << "\n"
+		      << "    raw bytes            : " << cs.raw_bytes << "\n"
+		      << "    sent bytes           : " << cs.msg_bytes << "\n"
+		      << "    compression ratio    : "
+		      << (cs.msg_bytes > 0 ? double(cs.raw_bytes)/cs.msg_bytes : 1.0) << "\n"
+		      << "    max compress time    : " << cs.compress_time << "\n"
+		      << "    max decompress time  : " << cs.decompress_time
+		      << std::endl;
+	}
     }
 
+    m_CC_stats.clear();
+
     initialized = false;
 }
 
@@ -1458,7 +1943,8 @@ MFIter::MFIter (const FabArrayBase& fabarray_,
     flags(flags_),
     index_map(0),
     local_index_map(0),
-    tile_array(0)
+    tile_array(0),
+    costs(0)
 {
     Initialize();
 }
@@ -1471,7 +1957,8 @@ MFIter::MFIter (const FabArrayBase& fabarray_,
     flags(do_tiling_ ? Tiling : 0),
     index_map(0),
     local_index_map(0),
-    tile_array(0)
+    tile_array(0),
+    costs(0)
 {
     Initialize();
 }
@@ -1485,13 +1972,37 @@ MFIter::MFIter (const FabArrayBase& fabarray_,
     flags(flags_ | Tiling),
     index_map(0),
     local_index_map(0),
-    tile_array(0)
+    tile_array(0),
+    costs(0)
 {
     Initialize();
 }
 
+MFIter::MFIter (const FabArrayBase& fabarray_,
+		FabCosts&           costs_,
+		bool                do_tiling_)
+    :
+    fabArray(fabarray_),
+    tile_size((do_tiling_) ? FabArrayBase::mfiter_tile_size : IntVect::TheZeroVector()),
+    flags(do_tiling_ ? Tiling : 0),
+    index_map(0),
+    local_index_map(0),
+    tile_array(0),
+    costs(&costs_)
+{
+    BL_ASSERT(costs->size() == fabArray.size());
+    Initialize();
+    tile_start = ParallelDescriptor::second();
+}
+
 MFIter::~MFIter ()
 {
+    //
+    // The loop may have been left early.
+    //
+    if (costs && currentIndex < endIndex)
+	addCost();
+
 #if BL_USE_TEAM
     if ( ! (flags & NoTeamBarrier) )
 	ParallelDescriptor::MyTeam().MemoryBarrier();
@@ -1581,6 +2092,56 @@ MFIter::Initialize ()
     }
 }
 
+void
+MFIter::addCost ()
+{
+    const double t = ParallelDescriptor::second();
+    costs->add(index(), t - tile_start);
+    tile_start = t;
+}
+
+FabCosts::FabCosts (const BoxArray& ba)
+{
+    define(ba);
+}
+
+FabCosts::FabCosts (const FabArrayBase& fa)
+{
+    define(fa.boxArray());
+}
+
+void
+FabCosts::define (const BoxArray& ba)
+{
+    m_ba = ba;
+    m_cost.resize(ba.size());
+    reset();
+}
+
+void
+FabCosts::reset ()
+{
+    for (int i = 0, N = m_cost.size(); i < N; ++i)
+	m_cost[i] = 0;
+}
+
+void
+FabCosts::add (int i, Real dt)
+{
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+    m_cost[i] += dt;
+}
+
+void
+FabCosts::Reduce (Array<Real>& cost) const
+{
+    cost = m_cost;
+    if (!cost.empty())
+	ParallelDescriptor::ReduceRealSum(cost.dataPtr(), cost.size());
+}
+
 Box 
 MFIter::tilebox () const
 { 
@@ -0,0 +1,144 @@
+
+#include <winstd.H>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#include <BLassert.H>
+#include <HArena.H>
+
+namespace
+{
+    inline
+    char*
+    align_up (char* p, std::size_t a)
+    {
+        const std::size_t r = reinterpret_cast<std::size_t>(p) % a;
+        return r == 0 ? p : p + (a - r);
+    }
+}
+
+HArena::HArena (std::size_t huge_min)
+    :
+    m_huge_min(huge_min == 0 ? std::size_t(HugePageSize) : huge_min),
+    m_used(0),
+    m_huge(0),
+    m_ncolour(0)
+{
+    BL_ASSERT(Alignment >= sizeof(Header));
+}
+
+HArena::~HArena () {}
+
+void*
+HArena::alloc (std::size_t nbytes)
+{
+    char* vp = 0;
+
+#if defined(__linux__) && defined(MAP_ANONYMOUS)
+    if (nbytes >= m_huge_min)
+    {
+        //
+        // The header is in the Alignment bytes in front of the block.  We
+        // map one huge page more than we need and unmap what sticks out on
+        // either side of a huge page boundary.
+        //
+        const std::size_t need = ((nbytes + Alignment*(NColours+1) + HugePageSize - 1)/HugePageSize)*HugePageSize;
+        const std::size_t len  = need + HugePageSize;
+
+        void* p = mmap(0, len, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+
+        if (p != MAP_FAILED)
+        {
+            char* raw  = static_cast<char*>(p);
+            char* base = align_up(raw, HugePageSize);
+
+            if (base > raw)
+                munmap(raw, base - raw);
+            if (raw + len > base + need)
+                munmap(base + need, (raw + len) - (base + need));
+#ifdef MADV_HUGEPAGE
+            madvise(base, need, MADV_HUGEPAGE);
+#endif
+            //
+            // Start blocks at different offsets into their first page so that
+            // FABs of the same size do not all map to the same cache sets.
+            //
+            const std::size_t colour = (m_ncolour++ % NColours);
+
+            vp = base + Alignment*(1 + colour);
+
+            Header* h = reinterpret_cast<Header*>(vp) - 1;
+            h->base   = base;
+            h->size   = need;
+            h->mapped = 1;
+
+            m_used += need;
+            m_huge += need;
+
+            return vp;
+        }
+        //
+        // Otherwise fall through to ::operator new().
+        //
+    }
+#endif
+
+    const std::size_t len = nbytes + Alignment + sizeof(Header);
+
+    char* raw = static_cast<char*>(::operator new(len));
+
+    vp = align_up(raw + sizeof(Header), Alignment);
+
+    Header* h = reinterpret_cast<Header*>(vp) - 1;
+    h->base   = raw;
+    h->size   = len;
+    h->mapped = 0;
+
+    m_used += len;
+
+    return vp;
+}
+
+void
+HArena::free (void* vp)
+{
+    if (vp == 0)
+        //
+        // Allow calls with NULL as allowed by C++ delete.
+        //
+        return;
+
+    const Header* h = static_cast<const Header*>(vp) - 1;
+
+#if defined(__linux__) && defined(MAP_ANONYMOUS)
+    if (h->mapped)
+    {
+        const std::size_t size = h->size;
+        m_used -= size;
+        m_huge -= size;
+        munmap(h->base, size);
+        return;
+    }
+#endif
+
+    BL_ASSERT(h->mapped == 0);
+
+    m_used -= h->size;
+
+    ::operator delete(h->base);
+}
+
+std::size_t
+HArena::heap_space_used () const
+{
+    return m_used;
+}
+
+std::size_t
+HArena::huge_space_used () const
+{
+    return m_huge;
+}
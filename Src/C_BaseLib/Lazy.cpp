@@ -1,4 +1,8 @@
+#include <cmath>
+#include <list>
+
 #include <Lazy.H>
+#include <ParallelDescriptor.H>
 
 namespace Lazy
 {
@@ -18,8 +22,8 @@ namespace Lazy
 
     void EvalReduction ()
     {
-	static int count = 0;
 #ifdef BL_USE_MPI
+	static int count = 0;
 	++count;
 	if (count == 1) {
 	    for (auto&& f : reduction_queue)
@@ -33,5 +37,216 @@ namespace Lazy
     void Finalize ()
     {
 	EvalReduction();
+	FinishReductions();
+    }
+
+    struct Batch;
+
+    struct DeferredReal::Slot
+    {
+	Real                   value;
+	int                    op;
+	bool                   take_sqrt;
+	bool                   done;
+	std::shared_ptr<Batch> batch;  // set while in flight
+    };
+
+    namespace
+    {
+	std::vector< std::shared_ptr<DeferredReal::Slot> > pending;
+    }
+
+#ifdef BL_USE_MPI
+    //
+    // The values travel as (op, value) pairs, so that sums, maxima and
+    // minima can share one allreduce with a user-defined operation.
+    //
+    struct Batch
+    {
+	Batch () : req(MPI_REQUEST_NULL) {}
+
+	MPI_Request                                        req;
+	std::vector<Real>                                  buf;
+	std::vector< std::shared_ptr<DeferredReal::Slot> > slots;
+    };
+
+    namespace
+    {
+	std::list< std::shared_ptr<Batch> > in_flight;
+
+	void
+	combine (void* invec, void* inoutvec, int* len, MPI_Datatype*)
+	{
+	    const Real* in    = static_cast<const Real*>(invec);
+	    Real*       inout = static_cast<Real*>(inoutvec);
+
+	    for (int i = 0; i < *len; ++i)
+	    {
+		const Real  a = in[2*i+1];
+		Real&       b = inout[2*i+1];
+
+		switch (int(in[2*i]))
+		{
+		case Sum: b += a;              break;
+		case Max: b  = std::max(a, b); break;
+		default:  b  = std::min(a, b);
+		}
+	    }
+	}
+
+	MPI_Datatype
+	pair_type ()
+	{
+	    static MPI_Datatype t = MPI_DATATYPE_NULL;
+	    if (t == MPI_DATATYPE_NULL)
+	    {
+		BL_MPI_REQUIRE( MPI_Type_contiguous(2, ParallelDescriptor::Mpi_typemap<Real>::type(), &t) );
+		BL_MPI_REQUIRE( MPI_Type_commit(&t) );
+	    }
+	    return t;
+	}
+
+	MPI_Op
+	combine_op ()
+	{
+	    static MPI_Op op = MPI_OP_NULL;
+	    if (op == MPI_OP_NULL)
+		BL_MPI_REQUIRE( MPI_Op_create(combine, 1, &op) );
+	    return op;
+	}
+
+	void
+	complete (std::shared_ptr<Batch> b)
+	{
+	    BL_MPI_REQUIRE( MPI_Wait(&b->req, MPI_STATUS_IGNORE) );
+
+	    for (int i = 0, N = b->slots.size(); i < N; ++i)
+	    {
+		DeferredReal::Slot& s = *b->slots[i];
+		s.value = b->buf[2*i+1];
+		if (s.take_sqrt)
+		    s.value = std::sqrt(s.value);
+		s.done = true;
+		s.batch.reset();
+	    }
+
+	    b->slots.clear();
+
+	    in_flight.remove(b);
+	}
+    }
+#else
+    struct Batch {};
+#endif
+
+    DeferredReal::DeferredReal (Real v)
+	:
+	m_slot(std::make_shared<Slot>())
+    {
+	m_slot->value     = v;
+	m_slot->op        = Sum;
+	m_slot->take_sqrt = false;
+	m_slot->done      = true;
+    }
+
+    Real
+    DeferredReal::get () const
+    {
+	if (!m_slot->done)
+	{
+	    if (!m_slot->batch)
+		StartReductions();
+#ifdef BL_USE_MPI
+	    complete(m_slot->batch);
+#endif
+	}
+
+	BL_ASSERT(m_slot->done);
+
+	return m_slot->value;
+    }
+
+    bool
+    DeferredReal::ready () const
+    {
+#ifdef BL_USE_MPI
+	if (!m_slot->done && m_slot->batch)
+	{
+	    int flag = 0;
+	    BL_MPI_REQUIRE( MPI_Test(&m_slot->batch->req, &flag, MPI_STATUS_IGNORE) );
+	    if (flag)
+		complete(m_slot->batch);
+	}
+#endif
+	return m_slot->done;
+    }
+
+    DeferredReal
+    QueueReduce (Real local, ReduceOp op, bool take_sqrt)
+    {
+	DeferredReal r(local);
+
+#ifdef BL_USE_MPI
+	if (ParallelDescriptor::NProcs() > 1)
+	{
+	    r.m_slot->op        = op;
+	    r.m_slot->take_sqrt = take_sqrt;
+	    r.m_slot->done      = false;
+
+	    pending.push_back(r.m_slot);
+
+	    return r;
+	}
+#endif
+	if (take_sqrt)
+	    r.m_slot->value = std::sqrt(local);
+
+	return r;
+    }
+
+    void
+    StartReductions ()
+    {
+#ifdef BL_USE_MPI
+	if (pending.empty()) return;
+
+	BL_PROFILE("Lazy::StartReductions()");
+
+	std::shared_ptr<Batch> b = std::make_shared<Batch>();
+
+	const int n = pending.size();
+
+	b->buf.resize(2*n);
+	b->slots.swap(pending);
+
+	for (int i = 0; i < n; ++i)
+	{
+	    b->buf[2*i]   = b->slots[i]->op;
+	    b->buf[2*i+1] = b->slots[i]->value;
+	    b->slots[i]->batch = b;
+	}
+
+#ifdef BL_USE_MPI3
+	BL_MPI_REQUIRE( MPI_Iallreduce(MPI_IN_PLACE, b->buf.data(), n, pair_type(), combine_op(),
+				       ParallelDescriptor::Communicator(), &b->req) );
+#else
+	BL_MPI_REQUIRE( MPI_Allreduce(MPI_IN_PLACE, b->buf.data(), n, pair_type(), combine_op(),
+				      ParallelDescriptor::Communicator()) );
+#endif
+
+	in_flight.push_back(b);
+#endif
+    }
+
+    void
+    FinishReductions ()
+    {
+#ifdef BL_USE_MPI
+	while (!in_flight.empty())
+	{
+	    std::shared_ptr<Batch> b = in_flight.front();
+	    complete(b);
+	}
+#endif
     }
 }
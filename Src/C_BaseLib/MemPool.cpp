@@ -9,6 +9,7 @@
 #include <cstring>
 
 #include <CArena.H>
+#include <SArena.H>
 #include <PArray.H>
 #include <MemPool.H>
 
@@ -23,6 +24,10 @@
 namespace
 {
     static PArray<CArena> the_memory_pool;
+    //
+    // Used instead of the above with fab.arena = SArena.
+    //
+    static SArena* the_slab_pool = 0;
 #if defined(BL_TESTING) || defined(DEBUG)
     static int init_snan = 1;
 #else
@@ -42,6 +47,12 @@ void mempool_init()
 #ifndef FORTRAN_BOXLIB
         ParmParse pp("fab");
 	pp.query("init_snan", init_snan);
+
+	std::string arena;
+	pp.query("arena", arena);
+	if (arena == "SArena") {
+	    the_slab_pool = new SArena();
+	}
 #endif
 
 #ifdef _OPENMP
@@ -49,9 +60,11 @@ void mempool_init()
 #else
 	int nthreads = 1;
 #endif
-	the_memory_pool.resize(nthreads, PArrayManage);
-	for (int i=0; i<nthreads; ++i) {
-	    the_memory_pool.set(i, new CArena());
+	if (the_slab_pool == 0) {
+	    the_memory_pool.resize(nthreads, PArrayManage);
+	    for (int i=0; i<nthreads; ++i) {
+		the_memory_pool.set(i, new CArena());
+	    }
 	}
 #ifdef _OPENMP
 #pragma omp parallel
@@ -77,6 +90,7 @@ void mempool_init()
 
 void* mempool_alloc (size_t nbytes)
 {
+  if (the_slab_pool) return the_slab_pool->alloc(nbytes);
 #ifdef _OPENMP
   int tid = omp_get_thread_num();
 #else
@@ -87,6 +101,10 @@ void* mempool_alloc (size_t nbytes)
 
 void mempool_free (void* p) 
 {
+  if (the_slab_pool) {
+      the_slab_pool->free(p);
+      return;
+  }
 #ifdef _OPENMP
   int tid = omp_get_thread_num();
 #else
@@ -100,8 +118,10 @@ void mempool_get_stats (int& mp_min, int& mp_max, int& mp_tot) // min, max & tot
   size_t hsu_min=std::numeric_limits<size_t>::max();
   size_t hsu_max=0;
   size_t hsu_tot=0;
-  for (int i=0; i<the_memory_pool.size(); ++i) {
-    size_t hsu = the_memory_pool[i].heap_space_used();
+  const int npools = the_slab_pool ? the_slab_pool->nThreads() : the_memory_pool.size();
+  for (int i=0; i<npools; ++i) {
+    size_t hsu = the_slab_pool ? the_slab_pool->heap_space_used(i)
+	                       : the_memory_pool[i].heap_space_used();
     hsu_min = std::min(hsu, hsu_min);
     hsu_max = std::max(hsu, hsu_max);
     hsu_tot += hsu;
@@ -42,6 +42,19 @@ MemProfiler::add (const std::string& name, std::function<NBuildsInfo()>&& f)
     mprofiler.the_funcs_builds.push_back(std::forward<std::function<NBuildsInfo()> >(f));
 }
 
+void 
+MemProfiler::add (const std::string& name, std::function<NCallsInfo()>&& f)
+{
+    MemProfiler& mprofiler = getInstance();
+    auto it = std::find(mprofiler.the_names_calls.begin(), mprofiler.the_names_calls.end(), name);
+    if (it != mprofiler.the_names_calls.end()) {
+        std::string s = "MemProfiler::add (NCallsInfo) failed because " + name + " already existed";
+        BoxLib::Abort(s.c_str());
+    }
+    mprofiler.the_names_calls.push_back(name);
+    mprofiler.the_funcs_calls.push_back(std::forward<std::function<NCallsInfo()> >(f));
+}
+
 MemProfiler& 
 MemProfiler::getInstance ()
 {
@@ -86,6 +99,16 @@ MemProfiler::report_ (const std::string& prefix, const std::string& memory_log_n
     std::vector<int>  num_builds_max = num_builds_min;
     std::vector<int>  hwm_builds_max = hwm_builds_min;
 
+    std::vector<long> num_calls_min;
+    std::vector<long> num_bytes_min;
+    for (auto&& f: the_funcs_calls) {
+	const NCallsInfo& cinfo = f();
+	num_calls_min.push_back(cinfo.ncalls);
+	num_bytes_min.push_back(cinfo.nbytes);
+    }
+    std::vector<long> num_calls_max = num_calls_min;
+    std::vector<long> num_bytes_max = num_bytes_min;
+
 #ifdef __linux
     const int N = 9;
 #else
@@ -201,6 +224,13 @@ MemProfiler::report_ (const std::string& prefix, const std::string& memory_log_n
     ParallelDescriptor::ReduceIntMin (&hwm_builds_min[0], hwm_builds_min.size(), IOProc);
     ParallelDescriptor::ReduceIntMax (&hwm_builds_max[0], hwm_builds_max.size(), IOProc);
 
+    if (!the_funcs_calls.empty()) {
+	ParallelDescriptor::ReduceLongMin(&num_calls_min[0], num_calls_min.size(), IOProc);
+	ParallelDescriptor::ReduceLongMax(&num_calls_max[0], num_calls_max.size(), IOProc);
+	ParallelDescriptor::ReduceLongMin(&num_bytes_min[0], num_bytes_min.size(), IOProc);
+	ParallelDescriptor::ReduceLongMax(&num_bytes_max[0], num_bytes_max.size(), IOProc);
+    }
+
     if (ParallelDescriptor::IOProcessor()) {
 
 	std::ofstream memlog(memory_log_name.c_str(), 
@@ -213,6 +243,8 @@ MemProfiler::report_ (const std::string& prefix, const std::string& memory_log_n
 		width_name = std::max(width_name, int(x.size()));
 	    for (auto& x: the_names_builds)
 		width_name = std::max(width_name, int(x.size()));
+	    for (auto& x: the_names_calls)
+		width_name = std::max(width_name, int(x.size()));
 	}
 	const int width_bytes = 18;
 
@@ -280,6 +312,28 @@ MemProfiler::report_ (const std::string& prefix, const std::string& memory_log_n
 	    }
 	}
 
+	// Number of calls since the last report
+	if (!the_names_calls.empty()) {
+	    memlog << "\n";
+	    memlog << ident;
+	    memlog << "| " << std::setw(width_name) << std::left << "Name" << " | "
+		   << std::setw(width_bytes) << std::right << "# Since Last  " << " | "
+		   << std::setw(width_bytes) << "Bytes Since Last " << " |\n";
+	    std::setw(0);
+
+	    memlog << ident;
+	    memlog << "|-" << dash_name << "-+-" << dash_bytes << "-+-" << dash_bytes << "-|\n";
+
+	    for (int i = 0; i < the_names_calls.size(); ++i) {
+		if (num_calls_max[i] > 0) {
+		    memlog << ident;
+		    memlog << "| " << std::setw(width_name) << std::left << the_names_calls[i] << " | ";
+		    memlog << Calls{num_calls_min[i],num_calls_max[i]} << " | ";
+		    memlog << Bytes{num_bytes_min[i],num_bytes_max[i]} << " |\n";
+		}
+	    }
+	}
+
 #ifdef __linux
 	if (ierr_proc_status == 0) {
 	    memlog << "\n";
@@ -353,3 +407,12 @@ operator<< (std::ostream& os, const MemProfiler::Builds& builds)
     os << std::setw(0);
     return os;
 }
+
+std::ostream& 
+operator<< (std::ostream& os, const MemProfiler::Calls& calls)
+{
+    os << std::setw(6) << std::right << calls.mn << " ... "
+       << std::setw(7) << std::left  << calls.mx; 
+    os << std::setw(0);
+    return os;
+}
@@ -13,6 +13,7 @@
 #include <BLProfiler.H>
 #include <ParmParse.H>
 #include <PArray.H>
+#include <BaseFab_f.H>
 
 #ifdef BL_MEM_PROFILING
 #include <MemProfiler.H>
@@ -23,6 +24,28 @@ namespace
     bool initialized = false;
     int num_multifabs     = 0;
     int num_multifabs_hwm = 0;
+    //
+    // Deferred reductions are batched on the default communicator;
+    // MultiFabs of other colors reduce right away.
+    //
+    Lazy::DeferredReal
+    deferred (Real                      local,
+              Lazy::ReduceOp            op,
+              ParallelDescriptor::Color color,
+              bool                      take_sqrt = false)
+    {
+        if (color == ParallelDescriptor::DefaultColor())
+            return Lazy::QueueReduce(local, op, take_sqrt);
+
+        switch (op)
+        {
+        case Lazy::Sum: ParallelDescriptor::ReduceRealSum(local, color); break;
+        case Lazy::Max: ParallelDescriptor::ReduceRealMax(local, color); break;
+        case Lazy::Min: ParallelDescriptor::ReduceRealMin(local, color); break;
+        }
+
+        return Lazy::DeferredReal(take_sqrt ? std::sqrt(local) : local);
+    }
 }
 
 MultiFabCopyDescriptor::MultiFabCopyDescriptor ()
@@ -57,6 +80,67 @@ MultiFab::Dot (const MultiFab& x, int xcomp,
     return sm;
 }
 
+Array<Real>
+MultiFab::Dot (const Array<const MultiFab*>& x, int xcomp,
+	       const Array<const MultiFab*>& y, int ycomp,
+	       int numcomp, int nghost, bool local)
+{
+    BL_PROFILE("MultiFab::Dot(Array)");
+
+    const int n = x.size();
+
+    BL_ASSERT(n > 0 && y.size() == n);
+
+    for (int i = 0; i < n; ++i)
+    {
+	BL_ASSERT(x[i]->boxArray() == x[0]->boxArray() && y[i]->boxArray() == x[0]->boxArray());
+	BL_ASSERT(x[i]->DistributionMap() == x[0]->DistributionMap());
+	BL_ASSERT(y[i]->DistributionMap() == x[0]->DistributionMap());
+	BL_ASSERT(x[i]->nGrow() >= nghost && y[i]->nGrow() >= nghost);
+    }
+
+#ifdef _OPENMP
+    int nthreads = omp_get_max_threads();
+#else
+    int nthreads = 1;
+#endif
+    PArray< Array<Real> > priv_sm(nthreads, PArrayManage);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+#ifdef _OPENMP
+	int tid = omp_get_thread_num();
+#else
+	int tid = 0;
+#endif
+	priv_sm.set(tid, new Array<Real>(n, 0.0));
+
+	for (MFIter mfi(*x[0],true); mfi.isValid(); ++mfi)
+	{
+	    const Box& bx = mfi.growntilebox(nghost);
+	    for (int i = 0; i < n; ++i) {
+		priv_sm[tid][i] += (*x[i])[mfi].dot(bx,xcomp,(*y[i])[mfi],bx,ycomp,numcomp);
+	    }
+	}
+#ifdef _OPENMP
+#pragma omp barrier
+#pragma omp for
+#endif
+	for (int i=0; i<n; i++) {
+	    for (int it=1; it<nthreads; it++) {
+		priv_sm[0][i] += priv_sm[it][i];
+	    }
+	}
+    }
+
+    if (!local)
+	ParallelDescriptor::ReduceRealSum(&priv_sm[0][0], n, x[0]->color());
+
+    return priv_sm[0];
+}
+
 void
 MultiFab::Add (MultiFab&       dst,
 	       const MultiFab& src,
@@ -257,6 +341,59 @@ MultiFab::LinComb (MultiFab&       dst,
     }
 }
 
+void
+MultiFab::Saxpy2 (MultiFab&       x,
+		  Real            a,
+		  const MultiFab& p,
+		  MultiFab&       y,
+		  const MultiFab& z,
+		  Real            b,
+		  const MultiFab& q,
+		  int             comp,
+		  int             numcomp,
+		  Real*           nrm,
+		  bool            local)
+{
+    BL_PROFILE("MultiFab::Saxpy2()");
+
+    BL_ASSERT(x.boxArray() == p.boxArray() && x.distributionMap == p.distributionMap);
+    BL_ASSERT(x.boxArray() == y.boxArray() && x.distributionMap == y.distributionMap);
+    BL_ASSERT(x.boxArray() == z.boxArray() && x.distributionMap == z.distributionMap);
+    BL_ASSERT(x.boxArray() == q.boxArray() && x.distributionMap == q.distributionMap);
+
+    Real xnm = 0.0, ynm = 0.0;
+
+#ifdef _OPENMP
+#pragma omp parallel reduction(max:xnm,ynm)
+#endif
+    for (MFIter mfi(x,true); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+
+        Real tnm[2] = { 0.0, 0.0 };
+
+        fort_fab_saxpy2_norm0(ARLIM_3D(bx.loVect()), ARLIM_3D(bx.hiVect()),
+                              BL_TO_FORTRAN_N_3D(x[mfi],comp),
+                              &a, BL_TO_FORTRAN_N_3D(p[mfi],comp),
+                              BL_TO_FORTRAN_N_3D(y[mfi],comp),
+                              BL_TO_FORTRAN_N_3D(z[mfi],comp),
+                              &b, BL_TO_FORTRAN_N_3D(q[mfi],comp),
+                              &numcomp, tnm);
+
+        xnm = std::max(xnm, tnm[0]);
+        ynm = std::max(ynm, tnm[1]);
+    }
+
+    if (nrm)
+    {
+        nrm[0] = xnm;
+        nrm[1] = ynm;
+
+        if (!local)
+            ParallelDescriptor::ReduceRealMax(nrm, 2, x.color());
+    }
+}
+
 void
 MultiFab::AddProduct (MultiFab&       dst,
 		      const MultiFab& src1,
@@ -1062,6 +1199,51 @@ MultiFab::sum (int comp, bool local) const
     return sm;
 }
 
+Lazy::DeferredReal
+MultiFab::min_nowait (int comp, int nghost) const
+{
+    return deferred(min(comp,nghost,true), Lazy::Min, this->color());
+}
+
+Lazy::DeferredReal
+MultiFab::max_nowait (int comp, int nghost) const
+{
+    return deferred(max(comp,nghost,true), Lazy::Max, this->color());
+}
+
+Lazy::DeferredReal
+MultiFab::norm0_nowait (int comp, int nghost) const
+{
+    return deferred(norm0(comp,nghost,true), Lazy::Max, this->color());
+}
+
+Lazy::DeferredReal
+MultiFab::norm1_nowait (int comp, int ngrow) const
+{
+    return deferred(norm1(comp,ngrow,true), Lazy::Sum, this->color());
+}
+
+Lazy::DeferredReal
+MultiFab::norm2_nowait (int comp) const
+{
+    const Real nm2 = MultiFab::Dot(*this, comp, *this, comp, 1, 0, true);
+    return deferred(nm2, Lazy::Sum, this->color(), true);
+}
+
+Lazy::DeferredReal
+MultiFab::sum_nowait (int comp) const
+{
+    return deferred(sum(comp,true), Lazy::Sum, this->color());
+}
+
+Lazy::DeferredReal
+MultiFab::Dot_nowait (const MultiFab& x, int xcomp,
+		      const MultiFab& y, int ycomp,
+		      int numcomp, int nghost)
+{
+    return deferred(MultiFab::Dot(x,xcomp,y,ycomp,numcomp,nghost,true), Lazy::Sum, x.color());
+}
+
 void
 MultiFab::minus (const MultiFab& mf,
                  int             strt_comp,
@@ -2357,6 +2357,46 @@ ParallelDescriptor::StartTeams ()
     int nprocs = ParallelDescriptor::NProcs();
     int rank   = ParallelDescriptor::MyProc();
 
+#ifdef BL_USE_MPI3
+    if (team_size < 0)
+    {
+	//
+	// One team per node.  This needs the same number of processes on
+	// every node with consecutive ranks, which is how most launchers
+	// place them by default.
+	//
+	MPI_Comm node_comm;
+	BL_MPI_REQUIRE( MPI_Comm_split_type(ParallelDescriptor::Communicator(), MPI_COMM_TYPE_SHARED,
+					    rank, MPI_INFO_NULL, &node_comm) );
+	int node_size, lo, hi;
+	BL_MPI_REQUIRE( MPI_Comm_size(node_comm, &node_size) );
+	BL_MPI_REQUIRE( MPI_Allreduce(&rank, &lo, 1, MPI_INT, MPI_MIN, node_comm) );
+	BL_MPI_REQUIRE( MPI_Allreduce(&rank, &hi, 1, MPI_INT, MPI_MAX, node_comm) );
+	BL_MPI_REQUIRE( MPI_Comm_free(&node_comm) );
+
+	int ok = (hi-lo+1 == node_size) && (lo % node_size == 0);
+	int min_size = node_size, max_size = node_size;
+	BL_MPI_REQUIRE( MPI_Allreduce(MPI_IN_PLACE, &ok, 1, MPI_INT, MPI_LAND,
+				      ParallelDescriptor::Communicator()) );
+	BL_MPI_REQUIRE( MPI_Allreduce(MPI_IN_PLACE, &min_size, 1, MPI_INT, MPI_MIN,
+				      ParallelDescriptor::Communicator()) );
+	BL_MPI_REQUIRE( MPI_Allreduce(MPI_IN_PLACE, &max_size, 1, MPI_INT, MPI_MAX,
+				      ParallelDescriptor::Communicator()) );
+
+	if (ok && min_size == max_size) {
+	    team_size = node_size;
+	} else {
+	    if (ParallelDescriptor::IOProcessor())
+		std::cout << "team.size = -1: processes are not placed in equal blocks of consecutive "
+			  << "ranks on the nodes, using team.size = 1\n";
+	    team_size = 1;
+	}
+    }
+#endif
+
+    if (team_size < 1)
+	BoxLib::Abort("team.size must be positive, or -1 for one team per node with USE_MPI3");
+
     if (nprocs % team_size != 0)
 	BoxLib::Abort("Number of processes not divisible by team size");
 
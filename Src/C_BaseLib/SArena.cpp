@@ -0,0 +1,319 @@
+
+#include <winstd.H>
+#include <new>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <BLassert.H>
+#include <SArena.H>
+
+//
+// Four classes per power of two from MinSize up to MaxSize.
+//
+const int SArena::NClasses = 81;
+
+namespace
+{
+    const int LogMinSize = 6;
+
+    inline
+    void*&
+    next_of (void* p)
+    {
+        return *static_cast<void**>(p);
+    }
+}
+
+SArena::Cache::Cache ()
+    :
+    freelist(SArena::NClasses, static_cast<void*>(0)),
+    remote(0),
+    heap_bytes(0),
+    used_bytes(0),
+    used_hwm(0),
+    nallocs(0),
+    alloc_bytes(0),
+    nfrees(0),
+    nremote(0)
+{}
+
+SArena::SArena ()
+{
+    BL_ASSERT(MinSize == (1 << LogMinSize));
+    BL_ASSERT(class_size(NClasses-1) == MaxSize);
+    BL_ASSERT(TagSize >= sizeof(Tag) && TagSize%Arena::align_size == 0);
+
+#ifdef _OPENMP
+    m_ncaches = omp_get_max_threads();
+#else
+    m_ncaches = 1;
+#endif
+
+    m_caches = new Cache[m_ncaches];
+    //
+    // A cache belongs to the thread that has its number now.  Others that
+    // later get the same number, e.g., in nested regions, will not use it.
+    //
+#ifdef _OPENMP
+#pragma omp parallel
+    {
+        const int tid = omp_get_thread_num();
+        if (tid < m_ncaches)
+            m_caches[tid].thread = std::this_thread::get_id();
+    }
+#else
+    m_caches[0].thread = std::this_thread::get_id();
+#endif
+}
+
+SArena::~SArena ()
+{
+    for (int c = 0; c < m_ncaches; ++c)
+        for (int i = 0, N = m_caches[c].m_alloc.size(); i < N; ++i)
+            ::operator delete(m_caches[c].m_alloc[i]);
+
+    delete [] m_caches;
+}
+
+int
+SArena::size_class (std::size_t nbytes, std::size_t& csize)
+{
+    if (nbytes <= MinSize)
+    {
+        csize = MinSize;
+        return 0;
+    }
+    //
+    // 2^p < nbytes <= 2^(p+1), and the classes in between are 2^(p-2) apart.
+    //
+    int p = LogMinSize;
+    while ((std::size_t(1) << (p+1)) < nbytes)
+        ++p;
+
+    const std::size_t lo   = std::size_t(1) << p;
+    const int         lgst = p - 2;
+    const int         j    = (nbytes - lo + (std::size_t(1) << lgst) - 1) >> lgst;
+
+    csize = lo + (std::size_t(j) << lgst);
+
+    return (p - LogMinSize)*4 + j;
+}
+
+std::size_t
+SArena::class_size (int cls)
+{
+    if (cls == 0) return MinSize;
+
+    const int p = LogMinSize + (cls-1)/4;
+    const int j = (cls-1)%4 + 1;
+
+    return (std::size_t(1) << p) + (std::size_t(j) << (p-2));
+}
+
+int
+SArena::my_cache ()
+{
+#ifdef _OPENMP
+    const int tid = omp_get_thread_num();
+#else
+    const int tid = 0;
+#endif
+    if (tid < m_ncaches && m_caches[tid].thread == std::this_thread::get_id())
+        return tid;
+
+    return -1;
+}
+
+void
+SArena::refill (int c, int cls)
+{
+    Cache& cache = m_caches[c];
+
+    const std::size_t stride = TagSize + class_size(cls);
+    //
+    // Small blocks come in slabs, big ones one at a time.
+    //
+    const std::size_t nblocks = stride <= SlabSize/16 ? SlabSize/stride : 1;
+    const std::size_t nbytes  = nblocks == 1 ? stride : std::size_t(SlabSize);
+
+    char* slab = static_cast<char*>(::operator new(nbytes));
+
+    cache.m_alloc.push_back(slab);
+    cache.heap_bytes += nbytes;
+
+    void* head = cache.freelist[cls];
+
+    for (std::size_t i = nblocks; i-- > 0; )
+    {
+        Tag* tag   = reinterpret_cast<Tag*>(slab + i*stride);
+        tag->cls   = cls;
+        tag->owner = c;
+
+        void* vp = reinterpret_cast<char*>(tag) + TagSize;
+        next_of(vp) = head;
+        head = vp;
+    }
+
+    cache.freelist[cls] = head;
+}
+
+void
+SArena::drain (int c)
+{
+    Cache& cache = m_caches[c];
+
+    void* vp = cache.remote.exchange(0, std::memory_order_acquire);
+
+    while (vp != 0)
+    {
+        void*      next = next_of(vp);
+        const Tag* tag  = reinterpret_cast<const Tag*>(static_cast<char*>(vp) - TagSize);
+
+        BL_ASSERT(tag->owner == c);
+
+        next_of(vp) = cache.freelist[tag->cls];
+        cache.freelist[tag->cls] = vp;
+
+        cache.used_bytes -= class_size(tag->cls);
+        cache.nfrees++;
+        cache.nremote++;
+
+        vp = next;
+    }
+}
+
+void*
+SArena::alloc (std::size_t nbytes)
+{
+    const int c = my_cache();
+
+    if (c < 0 || nbytes > MaxSize)
+    {
+        //
+        // Not one of ours; free() will hand it back to ::operator delete().
+        //
+        Tag* tag   = static_cast<Tag*>(::operator new(TagSize + nbytes));
+        tag->cls   = -1;
+        tag->owner = -1;
+        return reinterpret_cast<char*>(tag) + TagSize;
+    }
+
+    Cache& cache = m_caches[c];
+
+    std::size_t csize;
+    const int   cls = size_class(nbytes, csize);
+
+    if (cache.freelist[cls] == 0)
+    {
+        drain(c);
+
+        if (cache.freelist[cls] == 0)
+            refill(c, cls);
+    }
+
+    void* vp = cache.freelist[cls];
+    cache.freelist[cls] = next_of(vp);
+
+    cache.used_bytes += csize;
+    if (cache.used_bytes > cache.used_hwm)
+        cache.used_hwm = cache.used_bytes;
+    cache.nallocs++;
+    cache.alloc_bytes += nbytes;
+
+    BL_ASSERT(!(vp == 0));
+
+    return vp;
+}
+
+void
+SArena::free (void* vp)
+{
+    if (vp == 0)
+        //
+        // Allow calls with NULL as allowed by C++ delete.
+        //
+        return;
+
+    Tag* tag = reinterpret_cast<Tag*>(static_cast<char*>(vp) - TagSize);
+
+    if (tag->cls < 0)
+    {
+        ::operator delete(tag);
+        return;
+    }
+
+    BL_ASSERT(tag->owner >= 0 && tag->owner < m_ncaches);
+    BL_ASSERT(tag->cls < NClasses);
+
+    if (my_cache() == tag->owner)
+    {
+        Cache& cache = m_caches[tag->owner];
+
+        next_of(vp) = cache.freelist[tag->cls];
+        cache.freelist[tag->cls] = vp;
+
+        cache.used_bytes -= class_size(tag->cls);
+        cache.nfrees++;
+    }
+    else
+    {
+        //
+        // Push it onto the owner's list of returned blocks.  The owner only
+        // ever takes the whole list, so there is no ABA problem.
+        //
+        std::atomic<void*>& remote = m_caches[tag->owner].remote;
+
+        void* head = remote.load(std::memory_order_relaxed);
+        do {
+            next_of(vp) = head;
+        } while (!remote.compare_exchange_weak(head, vp,
+                                               std::memory_order_release,
+                                               std::memory_order_relaxed));
+    }
+}
+
+std::size_t
+SArena::heap_space_used () const
+{
+    std::size_t r = 0;
+    for (int c = 0; c < m_ncaches; ++c)
+        r += m_caches[c].heap_bytes;
+    return r;
+}
+
+std::size_t
+SArena::heap_space_used (int i) const
+{
+    BL_ASSERT(i >= 0 && i < m_ncaches);
+
+    return m_caches[i].heap_bytes;
+}
+
+SArena::Stats
+SArena::stats () const
+{
+    Stats s = { 0, 0, 0, 0, 0, 0, 0 };
+
+    for (int c = 0; c < m_ncaches; ++c)
+    {
+        const Cache& cache = m_caches[c];
+        s.heap_bytes  += cache.heap_bytes;
+        s.used_bytes  += cache.used_bytes;
+        s.used_hwm    += cache.used_hwm;
+        s.nallocs     += cache.nallocs;
+        s.alloc_bytes += cache.alloc_bytes;
+        s.nfrees      += cache.nfrees;
+        s.nremote     += cache.nremote;
+    }
+
+    return s;
+}
+
+void
+SArena::resetHWM ()
+{
+    for (int c = 0; c < m_ncaches; ++c)
+        m_caches[c].used_hwm = m_caches[c].used_bytes;
+}
@@ -6,7 +6,19 @@
 #include <sstream>
 #include <vector>
 #include <deque>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <cerrno>
+#include <cmath>
+#include <cstring>
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 //
 // This MUST be defined if don't have pubsetbuf() in I/O Streams Library.
 //
@@ -20,9 +32,11 @@
 #include <ParmParse.H>
 #include <NFiles.H>
 #include <FPC.H>
+#include <BLCompress.H>
 
 static const char *TheMultiFabHdrFileSuffix = "_H";
 static const char *FabFileSuffix = "_D_";
+static const char *HistogramFileSuffix = "_Hist";
 static const char *TheFabOnDiskPrefix = "FabOnDisk:";
 
 std::map<std::string, VisMF::PersistentIFStream> VisMF::persistentIFStreams;
@@ -37,6 +51,12 @@ bool VisMF::checkFilePositions(false);
 bool VisMF::usePersistentIFStreams(true);
 bool VisMF::useSynchronousReads(false);
 bool VisMF::useDynamicSetSelection(true);
+bool VisMF::useAsyncWrite(false);
+bool VisMF::useAggregatedReads(false);
+int  VisMF::nReadAggregators(0);
+long VisMF::aggReadSize(32 * VisMF::IO_Buffer_Size);
+Real VisMF::compressTolerance(0.0);
+int  VisMF::nHistogramBins(0);
 
 long VisMF::ioBufferSize(VisMF::IO_Buffer_Size);
 
@@ -50,6 +70,295 @@ int VisMF::nMFFileInStreams(1);
 namespace
 {
     bool initialized = false;
+    //
+    // A buffer staged by AsyncWrite() for the I/O thread, which writes
+    // it to the already positioned stream and closes the stream.
+    //
+    struct AsyncWriteJob
+    {
+        std::string       fileName;
+        std::ofstream    *stream;
+        std::vector<char> data;
+    };
+
+    std::thread                  ioThread;
+    std::mutex                   ioMutex;
+    std::condition_variable      ioCond;
+    std::deque<AsyncWriteJob *>  ioQueue;
+    bool                         ioBusy(false);
+    bool                         ioStop(false);
+    bool                         asyncWritesPosted(false);
+    std::string                  ioFailedFileName;
+
+    void
+    IOThread ()
+    {
+        for(;;) {
+          AsyncWriteJob *job;
+          {
+            std::unique_lock<std::mutex> lock(ioMutex);
+            ioCond.wait(lock, [] { return ioStop || ! ioQueue.empty(); });
+            if(ioQueue.empty()) {
+              return;
+            }
+            job = ioQueue.front();
+            ioQueue.pop_front();
+            ioBusy = true;
+          }
+
+          job->stream->write(job->data.data(), job->data.size());
+          job->stream->close();
+          const bool ok( ! job->stream->fail());
+
+          {
+            std::lock_guard<std::mutex> lock(ioMutex);
+            ioBusy = false;
+            if( ! ok && ioFailedFileName.empty()) {
+              ioFailedFileName = job->fileName;
+            }
+          }
+          ioCond.notify_all();
+
+          delete job->stream;
+          delete job;
+        }
+    }
+
+    void
+    PostAsyncWrite (AsyncWriteJob *job)
+    {
+        std::lock_guard<std::mutex> lock(ioMutex);
+        if( ! ioThread.joinable()) {
+          ioThread = std::thread(IOThread);
+        }
+        ioQueue.push_back(job);
+        ioCond.notify_all();
+    }
+
+    //
+    // An istream over a FAB, with its FAB header, already in memory.
+    //
+    struct MemoryStreamBuf
+        :
+        public std::streambuf
+    {
+        MemoryStreamBuf (char *data, long nBytes) { setg(data, data, data + nBytes); }
+    };
+
+    //
+    // Round each value to the fewest mantissa bits that keep its relative
+    // error within tol, so the low bytes become zero and compress away.
+    // Infinities and NaNs are left alone, as are values that would round
+    // up to infinity.
+    //
+    template <class T, class U>
+    void
+    RoundMantissa (T *data, long nValues, Real tol)
+    {
+        const int mantissaBits(std::numeric_limits<T>::digits - 1);
+        // ---- rounding to k bits has a relative error of at most 2^-(k+1)
+        int keepBits(static_cast<int>(std::ceil(-std::log2(tol))) - 1);
+        keepBits = std::max(0, std::min(mantissaBits, keepBits));
+        const int dropBits(mantissaBits - keepBits);
+        if(dropBits == 0) {
+          return;
+        }
+        const U half(U(1) << (dropBits - 1));
+        const U mask(~((U(1) << dropBits) - 1));
+        const U expMask((~U(0) >> 1) & ~((U(1) << mantissaBits) - 1));
+
+        for(long i(0); i < nValues; ++i) {
+          U u;
+          std::memcpy(&u, &data[i], sizeof(U));
+          if((u & expMask) == expMask) {
+            continue;
+          }
+          const U r((u + half) & mask);
+          if((r & expMask) != expMask) {
+            std::memcpy(&data[i], &r, sizeof(U));
+          }
+        }
+    }
+
+    void
+    RoundToTolerance (Real *data, long nValues, Real tol)
+    {
+#ifdef BL_USE_FLOAT
+        RoundMantissa<float, unsigned int>(data, nValues, tol);
+#else
+        RoundMantissa<double, unsigned long long>(data, nValues, tol);
+#endif
+    }
+
+    //
+    // Append the components of fab to out, each converted to rd and
+    // compressed on its own.  Returns the compressed size of each one.
+    //
+    Array<long>
+    CompressFab (const FArrayBox &fab, const RealDescriptor &rd, Real tol,
+                 std::vector<char> &out)
+    {
+        const long nPts(fab.box().numPts());
+        const int rdBytes(rd.numBytes());
+        const bool doConvert(rd != FPC::NativeRealDescriptor());
+        std::vector<Real> rounded;
+        std::vector<char> converted;
+        Array<long> csize(fab.nComp());
+
+        for(int n(0); n < fab.nComp(); ++n) {
+          const Real *values = fab.dataPtr(n);
+          if(tol > 0) {
+            rounded.assign(values, values + nPts);
+            RoundToTolerance(rounded.data(), nPts, tol);
+            values = rounded.data();
+          }
+          const void *src = values;
+          if(doConvert) {
+            converted.resize(nPts * rdBytes);
+            RealDescriptor::convertFromNativeFormat(converted.data(), nPts, values, rd);
+            src = converted.data();
+          }
+          const long start(out.size());
+          out.resize(start + BLCompress::MaxCompressedSize(nPts, rdBytes));
+          csize[n] = BLCompress::Compress(src, nPts, rdBytes, rdBytes, out.data() + start);
+          out.resize(start + csize[n]);
+        }
+        return csize;
+    }
+
+    //
+    // Read nComps compressed components, the first being firstComp, from
+    // the current position of is into data, nPts values per component.
+    //
+    void
+    ReadCompressed (std::istream &is, Real *data, long nPts, const Array<long> &csize,
+                    int firstComp, int nComps, const RealDescriptor &rd)
+    {
+        const int rdBytes(rd.numBytes());
+        const bool doConvert(rd != FPC::NativeRealDescriptor());
+        std::vector<char> compressed, converted(doConvert ? nPts * rdBytes : 0);
+
+        for(int n(0); n < nComps; ++n) {
+          const long nBytes(csize[firstComp + n]);
+          compressed.resize(nBytes);
+          is.read(compressed.data(), nBytes);
+          if( ! is.good() || is.gcount() != nBytes) {
+            BoxLib::Error("VisMF::ReadCompressed():  short read");
+          }
+          Real *dest = data + n * nPts;
+          if(doConvert) {
+            BLCompress::Decompress(compressed.data(), nBytes, converted.data(), nPts, rdBytes);
+            RealDescriptor::convertToNativeFormat(dest, nPts, converted.data(), rd);
+          } else {
+            BLCompress::Decompress(compressed.data(), nBytes, dest, nPts, rdBytes);
+          }
+        }
+    }
+
+    //
+    // Read fab idx as written with hdr from the current position of is.
+    //
+    void
+    ReadFabFrom (std::istream &is, FArrayBox &fab, const VisMF::Header &hdr, int idx)
+    {
+        if(hdr.m_vers == VisMF::Header::NoFabHeaderCompressed_v1) {
+          ReadCompressed(is, fab.dataPtr(), fab.box().numPts(), hdr.m_csize[idx],
+                         0, fab.nComp(), hdr.m_writtenRD);
+        } else if(VisMF::NoFabHeader(hdr)) {
+          if(hdr.m_writtenRD == FPC::NativeRealDescriptor()) {
+            is.read((char *) fab.dataPtr(), fab.nBytes());
+          } else {
+            long readDataItems(fab.box().numPts() * fab.nComp());
+            RealDescriptor::convertToNativeFormat(fab.dataPtr(), readDataItems,
+                                                  is, hdr.m_writtenRD);
+          }
+        } else {
+          fab.readFrom(is);
+        }
+    }
+
+    //
+    // Set the ghost cells of each FAB to one-half the average of the
+    // min and max over its valid region.
+    //
+    void
+    SetGhostToMidRange (const FabArray<FArrayBox> &mf)
+    {
+        FabArray<FArrayBox>* the_mf = const_cast<FabArray<FArrayBox>*>(&mf);
+
+        for(MFIter mfi(*the_mf); mfi.isValid(); ++mfi) {
+            const int idx(mfi.index());
+
+            for(int j(0); j < mf.nComp(); ++j) {
+                const Real valMin(mf[mfi].min(mf.box(idx), j));
+                const Real valMax(mf[mfi].max(mf.box(idx), j));
+                const Real val((valMin + valMax) / 2.0);
+
+                the_mf->get(mfi).setComplement(val, mf.box(idx), j, 1);
+            }
+        }
+    }
+
+    //
+    // The bin of v in nbins equal bins spanning [lo, hi].  This is
+    // monotone in v, so the bins of a range lie between those of its ends.
+    //
+    int
+    HistogramBin (Real v, Real lo, Real hi, int nbins)
+    {
+        if(hi <= lo || v <= lo) {
+          return 0;
+        }
+        const Real bin((v - lo) / ((hi - lo) / nbins));
+        return (bin < nbins) ? static_cast<int>(bin) : nbins - 1;
+    }
+
+    //
+    // Count the values of component comp of fab in bx into count.size()
+    // bins spanning [lo, hi].
+    //
+    void
+    CountValues (const FArrayBox &fab, const Box &bx, int comp,
+                 Real lo, Real hi, Array<long> &count)
+    {
+        const int nbins(count.size());
+        const long len(bx.length(0));
+        Box pencils(bx);
+        pencils.setBig(0, bx.smallEnd(0));
+
+        for(int i(0); i < nbins; ++i) {
+          count[i] = 0;
+        }
+        for(IntVect iv(pencils.smallEnd()); iv <= pencils.bigEnd(); pencils.next(iv)) {
+          const Real *p = &fab(iv, comp);
+          for(long i(0); i < len; ++i) {
+            ++count[HistogramBin(p[i], lo, hi, nbins)];
+          }
+        }
+    }
+
+    //
+    // The FAB of mfi as Real data:  the FAB itself, or a single precision
+    // FAB promoted into tmp, which is reused from FAB to FAB.
+    //
+    const FArrayBox &
+    RealFab (const FabArray<FArrayBox> &mf, const MFIter &mfi, FArrayBox &)
+    {
+        return mf[mfi];
+    }
+
+    const FArrayBox &
+    RealFab (const FabArray<BaseFab<float> > &mf, const MFIter &mfi, FArrayBox &tmp)
+    {
+        const BaseFab<float> &fab = mf[mfi];
+        tmp.resize(fab.box(), fab.nComp());
+        const float *src = fab.dataPtr();
+        Real *dst = tmp.dataPtr();
+        for(long i(0), N(fab.box().numPts() * fab.nComp()); i < N; ++i) {
+          dst[i] = src[i];
+        }
+        return tmp;
+    }
 }
 
 void
@@ -86,6 +395,12 @@ VisMF::Initialize ()
     pp.query("usepersistentifstreams", usePersistentIFStreams);
     pp.query("usesynchronousreads", useSynchronousReads);
     pp.query("usedynamicsetselection", useDynamicSetSelection);
+    pp.query("useasyncwrite", useAsyncWrite);
+    pp.query("useaggregatedreads", useAggregatedReads);
+    pp.query("nreadaggregators", nReadAggregators);
+    pp.query("aggreadsize", aggReadSize);
+    pp.query("compresstol", compressTolerance);
+    pp.query("nhistogrambins", nHistogramBins);
     pp.query("iobuffersize", ioBufferSize);
 
     initialized = true;
@@ -94,6 +409,18 @@ VisMF::Initialize ()
 void
 VisMF::Finalize ()
 {
+    VisMF::WaitForAsyncWrites();
+
+    if(ioThread.joinable()) {
+      {
+        std::lock_guard<std::mutex> lock(ioMutex);
+        ioStop = true;
+      }
+      ioCond.notify_all();
+      ioThread.join();
+      ioStop = false;
+    }
+
     initialized = false;
 }
 
@@ -261,6 +588,71 @@ operator>> (std::istream&         is,
     return is;
 }
 
+static
+std::ostream&
+operator<< (std::ostream&               os,
+            const Array< Array<long> >& ar)
+{
+    long i(0), N(ar.size()), M = (N == 0) ? 0 : ar[0].size();
+
+    os << N << ',' << M << '\n';
+
+    for( ; i < N; ++i) {
+        BL_ASSERT(ar[i].size() == M);
+
+        for(long j(0); j < M; ++j) {
+            os << ar[i][j] << ',';
+        }
+        os << '\n';
+    }
+
+    if( ! os.good()) {
+        BoxLib::Error("Write of Array<Array<long>> failed");
+    }
+
+    return os;
+}
+
+static
+std::istream&
+operator>> (std::istream&         is,
+            Array< Array<long> >& ar)
+{
+    char ch;
+    long i(0), N, M;
+
+    is >> N >> ch >> M;
+
+    if( N < 0 ) {
+      BoxLib::Error("Expected a positive integer, N, got something else");
+    }
+    if( M < 0 ) {
+      BoxLib::Error("Expected a positive integer, M, got something else");
+    }
+    if( ch != ',' ) {
+      BoxLib::Error("Expected a ',' got something else");
+    }
+
+    ar.resize(N);
+
+    for( ; i < N; ++i) {
+        ar[i].resize(M);
+
+        for(long j = 0; j < M; ++j) {
+            is >> ar[i][j] >> ch;
+	    if( ch != ',' ) {
+	      BoxLib::Error("Expected a ',' got something else");
+	    }
+        }
+    }
+
+    if( ! is.good()) {
+        BoxLib::Error("Read of Array<Array<long>> failed");
+    }
+
+    return is;
+}
+
 std::ostream&
 operator<< (std::ostream        &os,
             const VisMF::Header &hd)
@@ -282,13 +674,20 @@ operator<< (std::ostream        &os,
 
     os << hd.m_fod      << '\n';
 
-    if(hd.m_vers == VisMF::Header::Version_v1 ||
-       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1)
+    if(hd.m_vers == VisMF::Header::Version_v1           ||
+       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1 ||
+       hd.m_vers == VisMF::Header::NoFabHeaderCompressed_v1)
     {
       os << hd.m_min      << '\n';
       os << hd.m_max      << '\n';
     }
 
+    if(hd.m_vers == VisMF::Header::NoFabHeaderCompressed_v1) {
+      BL_ASSERT(hd.m_csize.size() == hd.m_ba.size());
+      os << hd.m_ctol     << '\n';
+      os << hd.m_csize    << '\n';
+    }
+
     if(hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1) {
       BL_ASSERT(hd.m_famin.size() == hd.m_ncomp);
       BL_ASSERT(hd.m_famin.size() == hd.m_famax.size());
@@ -302,9 +701,10 @@ operator<< (std::ostream        &os,
       os << '\n';
     }
 
-    if(hd.m_vers == VisMF::Header::NoFabHeader_v1       ||
-       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1 ||
-       hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1)
+    if(hd.m_vers == VisMF::Header::NoFabHeader_v1         ||
+       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1   ||
+       hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1 ||
+       hd.m_vers == VisMF::Header::NoFabHeaderCompressed_v1)
     {
       if(FArrayBox::getFormat() == FABio::FAB_NATIVE) {
         os << FPC::NativeRealDescriptor() << '\n';
@@ -356,8 +756,9 @@ operator>> (std::istream  &is,
     is >> hd.m_fod;
     BL_ASSERT(hd.m_ba.size() == hd.m_fod.size());
 
-    if(hd.m_vers == VisMF::Header::Version_v1 ||
-       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1)
+    if(hd.m_vers == VisMF::Header::Version_v1           ||
+       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1 ||
+       hd.m_vers == VisMF::Header::NoFabHeaderCompressed_v1)
     {
       is >> hd.m_min;
       is >> hd.m_max;
@@ -365,6 +766,12 @@ operator>> (std::istream  &is,
       BL_ASSERT(hd.m_ba.size() == hd.m_max.size());
     }
 
+    if(hd.m_vers == VisMF::Header::NoFabHeaderCompressed_v1) {
+      is >> hd.m_ctol;
+      is >> hd.m_csize;
+      BL_ASSERT(hd.m_ba.size() == hd.m_csize.size());
+    }
+
     if(hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1) {
       char ch;
       hd.m_famin.resize(hd.m_ncomp);
@@ -382,9 +789,10 @@ operator>> (std::istream  &is,
 	}
       }
     }
-    if(hd.m_vers == VisMF::Header::NoFabHeader_v1       ||
-       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1 ||
-       hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1)
+    if(hd.m_vers == VisMF::Header::NoFabHeader_v1         ||
+       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1   ||
+       hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1 ||
+       hd.m_vers == VisMF::Header::NoFabHeaderCompressed_v1)
     {
       is >> hd.m_writtenRD;
     }
@@ -406,6 +814,12 @@ VisMF::FabOnDisk::FabOnDisk (const std::string& name, long offset)
 {}
 
 
+VisMF::MappedFile::MappedFile()
+    :
+    data(0),
+    size(0)
+{}
+
 VisMF::FabReadLink::FabReadLink()
     :
     rankToRead(-1),
@@ -498,6 +912,73 @@ VisMF::max (int nComp) const
     return m_hdr.m_famax[nComp];
 }
 
+const VisMF::Histogram*
+VisMF::histogram (int fabIndex,
+                  int nComp) const
+{
+    BL_ASSERT(0 <= fabIndex && fabIndex < m_hdr.m_ba.size());
+    BL_ASSERT(0 <= nComp && nComp < m_hdr.m_ncomp);
+
+    if(m_hist.size() == 0) {  // ---- no histogram file
+      return 0;
+    }
+
+    return &m_hist[fabIndex][nComp];
+}
+
+bool
+VisMF::mayContain (int  fabIndex,
+                   int  nComp,
+                   Real lo,
+                   Real hi) const
+{
+    BL_ASSERT(0 <= fabIndex && fabIndex < m_hdr.m_ba.size());
+    BL_ASSERT(0 <= nComp && nComp < m_hdr.m_ncomp);
+
+    if(lo > hi) {
+      return false;
+    }
+    //
+    // The statistics are of the values before they were rounded on
+    // writing, so widen the range by twice the largest rounding error.
+    //
+    Real eps(0.0);
+    if(m_hdr.m_vers == VisMF::Header::NoFabHeaderCompressed_v1) {
+      eps += m_hdr.m_ctol;
+    }
+    if(m_hdr.m_vers == VisMF::Header::Version_v1 ||
+       m_hdr.m_writtenRD != FPC::NativeRealDescriptor())
+    {
+      eps += 1.2e-7;  // ---- possibly written as 32 bit reals
+    }
+    const Real qlo(lo - 2 * eps * std::abs(lo));
+    const Real qhi(hi + 2 * eps * std::abs(hi));
+
+    if(m_hdr.m_min.size() > 0) {
+      if(m_hdr.m_max[fabIndex][nComp] < qlo || m_hdr.m_min[fabIndex][nComp] > qhi) {
+        return false;
+      }
+    }
+
+    if(m_hist.size() > 0) {
+      const Histogram &h = m_hist[fabIndex][nComp];
+      if(h.hi < qlo || h.lo > qhi) {
+        return false;
+      }
+      const int nbins(h.count.size());
+      const int blo(HistogramBin(std::max(qlo, h.lo), h.lo, h.hi, nbins));
+      const int bhi(HistogramBin(std::min(qhi, h.hi), h.lo, h.hi, nbins));
+      for(int b(blo); b <= bhi; ++b) {
+        if(h.count[b] > 0) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    return true;
+}
+
 const FArrayBox&
 VisMF::GetFab (int fabIndex,
                int ncomp) const
@@ -546,6 +1027,68 @@ VisMF::readFAB (int idx,
     return VisMF::readFAB(idx, m_fafabname, m_hdr, ncomp);
 }
 
+FArrayBox*
+VisMF::mapFAB (int idx,
+	       int whichComp)
+{
+    BL_PROFILE("VisMF::mapFAB");
+
+    if( ! NoFabHeader(m_hdr) ||
+       m_hdr.m_vers == Header::NoFabHeaderCompressed_v1 ||
+       m_hdr.m_writtenRD != FPC::NativeRealDescriptor())
+    {
+      return 0;
+    }
+
+    std::string FullName(VisMF::DirName(m_fafabname));
+    FullName += m_hdr.m_fod[idx].m_name;
+
+    std::map<std::string, MappedFile>::iterator mfIter = m_mapped.find(FullName);
+
+    if(mfIter == m_mapped.end()) {
+      MappedFile mapped;
+#ifndef WIN32
+      int fd(open(FullName.c_str(), O_RDONLY));
+      if(fd >= 0) {
+        struct stat statBuf;
+        if(fstat(fd, &statBuf) == 0 && statBuf.st_size > 0) {
+          // ---- private, so writes to the fabs never reach the file
+          void *addr = mmap(0, statBuf.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+          if(addr != MAP_FAILED) {
+            mapped.data = static_cast<char *>(addr);
+            mapped.size = statBuf.st_size;
+          }
+        }
+        close(fd);
+      }
+#endif
+      mfIter = m_mapped.insert(std::make_pair(FullName, mapped)).first;
+    }
+
+    const MappedFile &mapped = mfIter->second;
+
+    Box fab_box(m_hdr.m_ba[idx]);
+    if(m_hdr.m_ngrow) {
+        fab_box.grow(m_hdr.m_ngrow);
+    }
+    const int  nComp(whichComp == -1 ? m_hdr.m_ncomp : 1);
+    const long nPts(fab_box.numPts());
+    const long offset(m_hdr.m_fod[idx].m_head
+                      + (whichComp == -1 ? 0 : whichComp) * nPts * sizeof(Real));
+
+    if(mapped.data == 0 ||
+       offset + nComp * nPts * static_cast<long>(sizeof(Real)) > mapped.size ||
+       offset % sizeof(Real) != 0)
+    {
+      return 0;
+    }
+
+    FArrayBox *fab = new FArrayBox(fab_box, nComp, false);
+    fab->setPtr(reinterpret_cast<Real *>(mapped.data + offset), nComp * nPts);
+
+    return fab;
+}
+
 std::string
 VisMF::BaseName (const std::string& filename)
 {
@@ -622,14 +1165,16 @@ VisMF::Write (const FArrayBox&   fab,
 
 VisMF::Header::Header ()
     :
-    m_vers(VisMF::Header::Undefined_v1)
+    m_vers(VisMF::Header::Undefined_v1),
+    m_ctol(0)
 {}
 
 //
 // The more-or-less complete header only exists at IOProcessor().
 //
 
-VisMF::Header::Header (const FabArray<FArrayBox>& mf,
+template <class FAB>
+VisMF::Header::Header (const FabArray<FAB>& mf,
                        VisMF::How      how,
 		       Version version,
 		       bool calcMinMax)
@@ -639,10 +1184,15 @@ VisMF::Header::Header (const FabArray<FArrayBox>& mf,
     m_ncomp(mf.nComp()),
     m_ngrow(mf.nGrow()),
     m_ba(mf.boxArray()),
-    m_fod(m_ba.size())
+    m_fod(m_ba.size()),
+    m_ctol(0)
 {
     BL_PROFILE("VisMF::Header");
 
+    if(version == NoFabHeaderCompressed_v1) {
+      m_csize.resize(m_ba.size());
+    }
+
     if(version == NoFabHeader_v1) {
       m_min.clear();
       m_max.clear();
@@ -658,11 +1208,13 @@ VisMF::Header::Header (const FabArray<FArrayBox>& mf,
       m_famin.resize(m_ncomp,  std::numeric_limits<Real>::max());
       m_famax.resize(m_ncomp, -std::numeric_limits<Real>::max());
 
+      FArrayBox tmp;
       for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
         const int idx = mfi.index();
+        const FArrayBox &fab = RealFab(mf, mfi, tmp);
         for(int i(0); i < m_ncomp; ++i) {
-          m_famin[i] = std::min(m_famin[i], mf[mfi].min(m_ba[idx],i));
-          m_famax[i] = std::max(m_famax[i], mf[mfi].max(m_ba[idx],i));
+          m_famin[i] = std::min(m_famin[i], fab.min(m_ba[idx],i));
+          m_famax[i] = std::max(m_famax[i], fab.max(m_ba[idx],i));
         }
       }
       ParallelDescriptor::ReduceRealMin(m_famin.dataPtr(), m_famin.size());
@@ -677,8 +1229,9 @@ VisMF::Header::Header (const FabArray<FArrayBox>& mf,
 }
 
 
+template <class FAB>
 void
-VisMF::Header::CalculateMinMax (const FabArray<FArrayBox>& mf,
+VisMF::Header::CalculateMinMax (const FabArray<FAB>& mf,
                                 int procToWrite)
 {
     BL_PROFILE("VisMF::CalculateMinMax");
@@ -690,17 +1243,19 @@ VisMF::Header::CalculateMinMax (const FabArray<FArrayBox>& mf,
     //
     // Calculate m_min and m_max on the CPU owning the fab.
     //
+    FArrayBox tmp;
     for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
         const int idx = mfi.index();
+        const FArrayBox &fab = RealFab(mf, mfi, tmp);
 
         m_min[idx].resize(m_ncomp);
         m_max[idx].resize(m_ncomp);
 
-        BL_ASSERT(mf[mfi].box().contains(m_ba[idx]));
+        BL_ASSERT(fab.box().contains(m_ba[idx]));
 
         for(long j(0); j < m_ncomp; ++j) {
-            m_min[idx][j] = mf[mfi].min(m_ba[idx],j);
-            m_max[idx][j] = mf[mfi].max(m_ba[idx],j);
+            m_min[idx][j] = fab.min(m_ba[idx],j);
+            m_max[idx][j] = fab.max(m_ba[idx],j);
         }
     }
 
@@ -784,17 +1339,19 @@ VisMF::Header::CalculateMinMax (const FabArray<FArrayBox>& mf,
         }
     }
 #else
+    FArrayBox tmp;
     for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
         const int idx = mfi.index();
+        const FArrayBox &fab = RealFab(mf, mfi, tmp);
 
         m_min[idx].resize(m_ncomp);
         m_max[idx].resize(m_ncomp);
 
-        BL_ASSERT(mf[mfi].box().contains(m_ba[idx]));
+        BL_ASSERT(fab.box().contains(m_ba[idx]));
 
         for(long j(0); j < m_ncomp; ++j) {
-            m_min[idx][j] = mf[mfi].min(m_ba[idx],j);
-            m_max[idx][j] = mf[mfi].max(m_ba[idx],j);
+            m_min[idx][j] = fab.min(m_ba[idx],j);
+            m_max[idx][j] = fab.max(m_ba[idx],j);
         }
     }
 #endif /*BL_USE_MPI*/
@@ -839,6 +1396,81 @@ VisMF::Header::CalculateMinMax (const FabArray<FArrayBox>& mf,
 }
 
 
+void
+VisMF::Header::GatherCompressedSizes (const FabArrayBase& mf,
+                                      int procToWrite)
+{
+    BL_PROFILE("VisMF::GatherCompressedSizes");
+
+#ifdef BL_USE_MPI
+    const int myProc(ParallelDescriptor::MyProc());
+
+    Array<int> nmtags(ParallelDescriptor::NProcs(), 0);
+    Array<int> offset(ParallelDescriptor::NProcs(), 0);
+
+    const Array<int> &pmap = mf.DistributionMap().ProcessorMap();
+
+    for(int i(0), N = mf.size(); i < N; ++i) {
+        //
+        // Each Fab corresponds to m_ncomp sizes.
+        //
+        nmtags[pmap[i]] += m_ncomp;
+    }
+
+    for(int i(1), N(offset.size()); i < N; ++i) {
+        offset[i] = offset[i-1] + nmtags[i-1];
+    }
+
+    //
+    // Can't let senddata or recvdata be empty as dataPtr() will fail.
+    //
+    Array<long> senddata(std::max(1, nmtags[myProc]));
+
+    int ioffset = 0;
+
+    for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        const int idx = mfi.index();
+        for(int i(0); i < m_ncomp; ++i) {
+            senddata[ioffset++] = m_csize[idx][i];
+        }
+    }
+
+    BL_ASSERT(ioffset == nmtags[myProc]);
+
+    Array<long> recvdata(std::max(1, mf.size()*m_ncomp));
+
+    BL_COMM_PROFILE(BLProfiler::Gatherv, recvdata.size() * sizeof(long),
+                    myProc, BLProfiler::BeforeCall());
+
+    BL_MPI_REQUIRE( MPI_Gatherv(senddata.dataPtr(),
+                                nmtags[myProc],
+                                ParallelDescriptor::Mpi_typemap<long>::type(),
+                                recvdata.dataPtr(),
+                                nmtags.dataPtr(),
+                                offset.dataPtr(),
+                                ParallelDescriptor::Mpi_typemap<long>::type(),
+                                procToWrite,
+                                ParallelDescriptor::Communicator()) );
+
+    BL_COMM_PROFILE(BLProfiler::Gatherv, recvdata.size() * sizeof(long),
+                    myProc, BLProfiler::AfterCall());
+
+    if(myProc == procToWrite) {
+        for(int j(0), N(mf.size()); j < N; ++j) {
+            if(pmap[j] != procToWrite) {
+                m_csize[j].resize(m_ncomp);
+                for(int k(0); k < m_ncomp; ++k) {
+                    m_csize[j][k] = recvdata[offset[pmap[j]]+k];
+                }
+
+                offset[pmap[j]] += m_ncomp;
+            }
+        }
+    }
+#endif /*BL_USE_MPI*/
+}
+
+
 long
 VisMF::WriteHeader (const std::string &mf_name,
                     VisMF::Header     &hdr,
@@ -864,26 +1496,149 @@ VisMF::WriteHeader (const std::string &mf_name,
             BoxLib::FileOpenFailed(MFHdrFileName);
 	}
 
-        MFHdrFile << hdr;
+        MFHdrFile << hdr;
+
+        //
+        // Add in the number of bytes written out in the Header.
+        //
+        bytesWritten += VisMF::FileOffset(MFHdrFile);
+
+        MFHdrFile.flush();
+        MFHdrFile.close();
+
+	if(checkFilePositions) {
+          std::stringstream hss;
+	  hss << hdr;
+	  if(hss.tellp() != bytesWritten) {
+	    std::cerr << "**** tellp error: hss.tellp() != bytesWritten :  "
+	              << hss.tellp() << "  " << bytesWritten << std::endl;
+	  }
+	}
+	
+    }
+    return bytesWritten;
+}
+
+template <class FAB>
+long
+VisMF::WriteHistograms (const FabArray<FAB> &mf,
+                        const std::string         &mf_name,
+			int                        procToWrite)
+{
+    BL_PROFILE("VisMF::WriteHistograms");
+
+    const int myProc(ParallelDescriptor::MyProc());
+    const std::string histFileName(mf_name + HistogramFileSuffix);
+
+    if(nHistogramBins <= 0) {
+      if(myProc == procToWrite) {
+        std::remove(histFileName.c_str());  // ---- a stale one would mislead queries
+      }
+      return 0;
+    }
+
+    const int nComps(mf.nComp());
+    const int nBins(nHistogramBins);
+    //
+    // Each Fab corresponds to nComps * (lo, hi, counts) Reals.
+    //
+    const int fabReals(nComps * (2 + nBins));
+    const Array<int> &pmap = mf.DistributionMap().ProcessorMap();
+
+    Array<int> nmtags(ParallelDescriptor::NProcs(), 0);
+    Array<int> offset(ParallelDescriptor::NProcs(), 0);
+
+    for(int i(0), N = mf.size(); i < N; ++i) {
+        nmtags[pmap[i]] += fabReals;
+    }
+
+    for(int i(1), N(offset.size()); i < N; ++i) {
+        offset[i] = offset[i-1] + nmtags[i-1];
+    }
+    //
+    // Can't let senddata or recvdata be empty as dataPtr() will fail.
+    //
+    Array<Real> senddata(std::max(1, nmtags[myProc]));
+    Array<long> count(nBins);
+
+    int ioffset = 0;
+
+    FArrayBox tmp;
+    for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        const Box &vbx = mf.box(mfi.index());
+        const FArrayBox &fab = RealFab(mf, mfi, tmp);
+        for(int n(0); n < nComps; ++n) {
+          const Real lo(fab.min(vbx, n));
+          const Real hi(fab.max(vbx, n));
+          CountValues(fab, vbx, n, lo, hi, count);
+          senddata[ioffset++] = lo;
+          senddata[ioffset++] = hi;
+          for(int b(0); b < nBins; ++b) {
+            senddata[ioffset++] = count[b];
+          }
+        }
+    }
+
+    BL_ASSERT(ioffset == nmtags[myProc]);
+
+#ifdef BL_USE_MPI
+    Array<Real> recvdata(std::max(1, mf.size() * fabReals));
+
+    BL_COMM_PROFILE(BLProfiler::Gatherv, recvdata.size() * sizeof(Real),
+                    myProc, BLProfiler::BeforeCall());
+
+    BL_MPI_REQUIRE( MPI_Gatherv(senddata.dataPtr(),
+                                nmtags[myProc],
+                                ParallelDescriptor::Mpi_typemap<Real>::type(),
+                                recvdata.dataPtr(),
+                                nmtags.dataPtr(),
+                                offset.dataPtr(),
+                                ParallelDescriptor::Mpi_typemap<Real>::type(),
+                                procToWrite,
+                                ParallelDescriptor::Communicator()) );
+
+    BL_COMM_PROFILE(BLProfiler::Gatherv, recvdata.size() * sizeof(Real),
+                    myProc, BLProfiler::AfterCall());
+#else
+    Array<Real> &recvdata = senddata;
+#endif /*BL_USE_MPI*/
+
+    long bytesWritten(0);
+
+    if(myProc == procToWrite) {
+        std::ofstream histFile(histFileName.c_str(), std::ios::out | std::ios::trunc);
+
+        if( ! histFile.good()) {
+            BoxLib::FileOpenFailed(histFileName);
+	}
+
+        histFile.setf(std::ios::floatfield, std::ios::scientific);
+        histFile.precision(16);
 
-        //
-        // Add in the number of bytes written out in the Header.
-        //
-        bytesWritten += VisMF::FileOffset(MFHdrFile);
+        histFile << mf.size() << ' ' << nComps << ' ' << nBins << '\n';
 
-        MFHdrFile.flush();
-        MFHdrFile.close();
+        for(int j(0), N(mf.size()); j < N; ++j) {
+            const Real *fabData = recvdata.dataPtr() + offset[pmap[j]];
+            for(int k(0); k < nComps; ++k) {
+                const Real *h = fabData + k * (2 + nBins);
+                histFile << h[0] << ' ' << h[1];
+                for(int b(0); b < nBins; ++b) {
+                    histFile << ' ' << static_cast<long>(h[2 + b]);
+                }
+                histFile << '\n';
+            }
+            offset[pmap[j]] += fabReals;
+        }
 
-	if(checkFilePositions) {
-          std::stringstream hss;
-	  hss << hdr;
-	  if(hss.tellp() != bytesWritten) {
-	    std::cerr << "**** tellp error: hss.tellp() != bytesWritten :  "
-	              << hss.tellp() << "  " << bytesWritten << std::endl;
-	  }
-	}
-	
+        bytesWritten += VisMF::FileOffset(histFile);
+
+        histFile.close();
+
+        if( ! histFile.good()) {
+            BoxLib::Error("VisMF::WriteHistograms failed");
+        }
     }
+
     return bytesWritten;
 }
 
@@ -897,6 +1652,48 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
     BL_ASSERT(mf_name[mf_name.length() - 1] != '/');
     BL_ASSERT(currentVersion != VisMF::Header::Undefined_v1);
 
+    const bool compressed(currentVersion == VisMF::Header::NoFabHeaderCompressed_v1);
+
+    if(useAsyncWrite && ! compressed &&
+       FArrayBox::getFormat() != FABio::FAB_ASCII &&
+       FArrayBox::getFormat() != FABio::FAB_8BIT)
+    {
+      return VisMF::AsyncWrite(mf, mf_name, how, set_ghost);
+    }
+
+    if(set_ghost) {
+        SetGhostToMidRange(mf);
+    }
+
+    return VisMF::WriteFabArray(mf, mf_name, how);
+}
+
+long
+VisMF::Write (const FabArray<BaseFab<float> >& mf,
+              const std::string&               mf_name,
+              VisMF::How                       how)
+{
+    BL_PROFILE("VisMF::Write_sFabArray");
+    BL_ASSERT(mf_name[mf_name.length() - 1] != '/');
+    BL_ASSERT(currentVersion != VisMF::Header::Undefined_v1);
+
+    return VisMF::WriteFabArray(mf, mf_name, how);
+}
+
+template <class FAB>
+long
+VisMF::WriteFabArray (const FabArray<FAB>& mf,
+                      const std::string&   mf_name,
+                      VisMF::How           how)
+{
+    const bool compressed(currentVersion == VisMF::Header::NoFabHeaderCompressed_v1);
+
+    if(FArrayBox::getFormat() == FABio::FAB_ASCII ||
+       FArrayBox::getFormat() == FABio::FAB_8BIT)
+    {
+      BoxLib::Error("VisMF::Write:  needs a binary FAB format");
+    }
+
     // ---- add stream retry
     // ---- add stream buffer (to nfiles)
     RealDescriptor *whichRD;
@@ -909,27 +1706,22 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
     }
     bool doConvert(*whichRD != FPC::NativeRealDescriptor());
 
-    if(set_ghost) {
-        FabArray<FArrayBox>* the_mf = const_cast<FabArray<FArrayBox>*>(&mf);
-
-        for(MFIter mfi(*the_mf); mfi.isValid(); ++mfi) {
-            const int idx(mfi.index());
-
-            for(int j(0); j < mf.nComp(); ++j) {
-                const Real valMin(mf[mfi].min(mf.box(idx), j));
-                const Real valMax(mf[mfi].max(mf.box(idx), j));
-                const Real val((valMin + valMax) / 2.0);
-
-                the_mf->get(mfi).setComplement(val, mf.box(idx), j, 1);
-            }
-        }
-    }
-
     int coordinatorProc(ParallelDescriptor::IOProcessorNumber());
     long bytesWritten(0);
     bool calcMinMax(false);
     VisMF::Header hdr(mf, how, currentVersion, calcMinMax);
 
+    // ---- compress before the sets take turns writing
+    std::vector<char> compressedData;
+    FArrayBox tmp;
+    if(compressed) {
+      hdr.m_ctol = compressTolerance;
+      for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        hdr.m_csize[mfi.index()] = CompressFab(RealFab(mf, mfi, tmp), *whichRD,
+                                               compressTolerance, compressedData);
+      }
+    }
+
     std::string filePrefix(mf_name + FabFileSuffix);
 
     NFilesIter nfi(nOutFiles, filePrefix, groupSets, setBuf);
@@ -940,18 +1732,25 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
         nfi.SetDynamic();
       }
       for( ; nfi.ReadyToWrite(); ++nfi) {
+	  if(compressed) {
+            nfi.Stream().write(compressedData.data(), compressedData.size());
+            nfi.Stream().flush();
+            bytesWritten += compressedData.size();
+	    continue;
+	  }
 	  // ---- find the total number of bytes including fab headers if needed
           const FABio &fio = FArrayBox::getFABio();
           int whichRDBytes(whichRD->numBytes()), nFABs(0);
           long writeDataItems(0), writeDataSize(0);
           for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
-	    const FArrayBox &fab = mf[mfi];
+	    const Box &fbx = mf.fabbox(mfi.index());
 	    if(oldHeader) {
 	      std::stringstream hss;
-	      fio.write_header(hss, fab, fab.nComp());
+	      FArrayBox hfab(fbx, mf.nComp(), false);  // ---- no alloc
+	      fio.write_header(hss, hfab, mf.nComp());
 	      bytesWritten += hss.tellp();
 	    }
-	    bytesWritten += fab.box().numPts() * mf.nComp() * whichRDBytes;
+	    bytesWritten += fbx.numPts() * mf.nComp() * whichRDBytes;
 	    ++nFABs;
 	  }
 	  char *allFabData(nullptr);
@@ -969,7 +1768,7 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
             long writePosition(0);
             for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
               int hLength(0);
-              const FArrayBox &fab = mf[mfi];
+              const FArrayBox &fab = RealFab(mf, mfi, tmp);
 	      writeDataItems = fab.box().numPts() * mf.nComp();
 	      writeDataSize = writeDataItems * whichRDBytes;
 	      char *afPtr = allFabData + writePosition;
@@ -995,7 +1794,7 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
 	  } else {    // ---- write fabs individually
             for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
               int hLength(0);
-              const FArrayBox &fab = mf[mfi];
+              const FArrayBox &fab = RealFab(mf, mfi, tmp);
 	      writeDataItems = fab.box().numPts() * mf.nComp();
 	      writeDataSize = writeDataItems * whichRDBytes;
 	      if(oldHeader) {
@@ -1026,15 +1825,22 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
       coordinatorProc = nfi.CoordinatorProc();
     }
 
-    if(currentVersion == VisMF::Header::Version_v1 ||
-       currentVersion == VisMF::Header::NoFabHeaderMinMax_v1)
+    if(currentVersion == VisMF::Header::Version_v1           ||
+       currentVersion == VisMF::Header::NoFabHeaderMinMax_v1 ||
+       currentVersion == VisMF::Header::NoFabHeaderCompressed_v1)
     {
       hdr.CalculateMinMax(mf, coordinatorProc);
     }
 
+    if(compressed) {
+      hdr.GatherCompressedSizes(mf, coordinatorProc);
+    }
+
     VisMF::FindOffsets(mf, filePrefix, hdr, groupSets, currentVersion,
 		       useDynamicSetSelection, nfi);
 
+    bytesWritten += VisMF::WriteHistograms(mf, mf_name, coordinatorProc);
+
     bytesWritten += VisMF::WriteHeader(mf_name, hdr, coordinatorProc);
 
     delete whichRD;
@@ -1043,8 +1849,219 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
 }
 
 
+long
+VisMF::AsyncWrite (const FabArray<FArrayBox>&    mf,
+                   const std::string& mf_name,
+                   VisMF::How         how,
+                   bool               set_ghost)
+{
+    BL_PROFILE("VisMF::AsyncWrite");
+    BL_ASSERT(mf_name[mf_name.length() - 1] != '/');
+    BL_ASSERT(currentVersion != VisMF::Header::Undefined_v1);
+
+    if(FArrayBox::getFormat() == FABio::FAB_ASCII ||
+       FArrayBox::getFormat() == FABio::FAB_8BIT  ||
+       currentVersion == VisMF::Header::NoFabHeaderCompressed_v1)
+    {
+      // ---- the sizes of these are not known in advance
+      return VisMF::Write(mf, mf_name, how, set_ghost);
+    }
+
+    RealDescriptor *whichRD;
+    if(FArrayBox::getFormat() == FABio::FAB_NATIVE) {
+      whichRD = FPC::NativeRealDescriptor().clone();
+    } else if(FArrayBox::getFormat() == FABio::FAB_NATIVE_32) {
+      whichRD = FPC::Native32RealDescriptor().clone();
+    } else {
+      whichRD = FPC::Ieee32NormalRealDescriptor().clone();
+    }
+    bool doConvert(*whichRD != FPC::NativeRealDescriptor());
+
+    if(set_ghost) {
+        SetGhostToMidRange(mf);
+    }
+
+    const int myProc(ParallelDescriptor::MyProc());
+    const int nProcs(ParallelDescriptor::NProcs());
+    const int coordinatorProc(ParallelDescriptor::IOProcessorNumber());
+
+    bool calcMinMax(false);
+    VisMF::Header hdr(mf, how, currentVersion, calcMinMax);
+
+    if(currentVersion == VisMF::Header::Version_v1 ||
+       currentVersion == VisMF::Header::NoFabHeaderMinMax_v1)
+    {
+      hdr.CalculateMinMax(mf, coordinatorProc);
+    }
+
+    const std::string filePrefix(mf_name + FabFileSuffix);
+    const int nFiles(NFilesIter::ActualNFiles(nOutFiles));
+    const int myFileNumber(NFilesIter::FileNumber(nFiles, myProc, groupSets));
+    const std::string myFileName(NFilesIter::FileName(myFileNumber, filePrefix));
+
+    const FABio &fio = FArrayBox::getFABio();
+    const bool oldHeader(currentVersion == VisMF::Header::Version_v1);
+    const int whichRDBytes(whichRD->numBytes());
+    const int nComps(mf.nComp());
+    const BoxArray &mfBA = mf.boxArray();
+    const DistributionMapping &mfDM = mf.DistributionMap();
+    //
+    // The static set layout:  the ranks writing to a file follow one another
+    // in rank order, each writing its fabs in index order.  Every rank can
+    // find where its fabs go without communication.  The header only needs
+    // the offsets on the coordinator.
+    //
+    std::map<int, Array<int> > rankBoxOrder;  // ---- [rank, boxarray index array]
+    for(int i(0); i < mfBA.size(); ++i) {
+      rankBoxOrder[mfDM[i]].push_back(i);
+    }
+
+    Array<long> currentOffset(nFiles, 0L);
+    long myOffset(0), myBytes(0);
+
+    for(std::map<int, Array<int> >::const_iterator rbo = rankBoxOrder.begin();
+        rbo != rankBoxOrder.end(); ++rbo)
+    {
+      const int rank(rbo->first);
+      const int fileNumber(NFilesIter::FileNumber(nFiles, rank, groupSets));
+      if(fileNumber != myFileNumber && myProc != coordinatorProc) {
+        continue;
+      }
+      const std::string fileName(VisMF::BaseName(NFilesIter::FileName(fileNumber, filePrefix)));
+      const Array<int> &index = rbo->second;
+
+      if(rank == myProc) {
+        myOffset = currentOffset[fileNumber];
+      }
+      for(int i(0); i < index.size(); ++i) {
+        long fabHeaderBytes(0);
+        if(oldHeader) {
+          std::stringstream hss;
+          FArrayBox tempFab(mf.fabbox(index[i]), nComps, false);  // ---- no alloc
+          fio.write_header(hss, tempFab, tempFab.nComp());
+          fabHeaderBytes = hss.tellp();
+        }
+        hdr.m_fod[index[i]].m_name = fileName;
+        hdr.m_fod[index[i]].m_head = currentOffset[fileNumber];
+        currentOffset[fileNumber] += mf.fabbox(index[i]).numPts() * nComps * whichRDBytes
+                                     + fabHeaderBytes;
+      }
+      if(rank == myProc) {
+        myBytes = currentOffset[fileNumber] - myOffset;
+      }
+    }
+    //
+    // The first rank of each set creates the file.  The files are opened
+    // here, so that they can be renamed, e.g., from an Amr ".temp"
+    // directory, while the I/O thread writes to them.
+    //
+    if(NFilesIter::WhichSetPosition(myProc, nProcs, nFiles, groupSets) == 0) {
+      std::ofstream ofs(myFileName.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+      if( ! ofs.good()) {
+        BoxLib::FileOpenFailed(myFileName);
+      }
+    }
+    ParallelDescriptor::Barrier("VisMF::AsyncWrite");
+
+    long bytesWritten(0);
+
+    if(myBytes > 0) {
+      AsyncWriteJob *job = new AsyncWriteJob;
+      job->fileName = myFileName;
+      job->data.resize(myBytes);
+
+      long writePosition(0);
+      for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        int hLength(0);
+        const FArrayBox &fab = mf[mfi];
+        long writeDataItems(fab.box().numPts() * nComps);
+        long writeDataSize(writeDataItems * whichRDBytes);
+        char *afPtr = job->data.data() + writePosition;
+        if(oldHeader) {
+          std::stringstream hss;
+          fio.write_header(hss, fab, fab.nComp());
+          hLength = hss.tellp();
+          memcpy(afPtr, hss.str().c_str(), hLength);  // ---- the fab header
+        }
+        if(doConvert) {
+          RealDescriptor::convertFromNativeFormat(static_cast<void *> (afPtr + hLength),
+                                                  writeDataItems,
+                                                  fab.dataPtr(), *whichRD);
+        } else {    // ---- copy from the fab
+          memcpy(afPtr + hLength, fab.dataPtr(), writeDataSize);
+        }
+        writePosition += hLength + writeDataSize;
+      }
+      BL_ASSERT(writePosition == myBytes);
+
+      job->stream = new std::ofstream(myFileName.c_str(),
+                                      std::ios::in | std::ios::out | std::ios::binary);
+      if( ! job->stream->good()) {
+        BoxLib::FileOpenFailed(myFileName);
+      }
+      job->stream->seekp(myOffset);
+
+      bytesWritten += myBytes;
+      PostAsyncWrite(job);
+    }
+
+    if(myProc == coordinatorProc) {
+      std::stringstream hss;
+      hss << hdr;
+      const std::string hstr(hss.str());
+
+      AsyncWriteJob *job = new AsyncWriteJob;
+      job->fileName = mf_name + TheMultiFabHdrFileSuffix;
+      job->data.assign(hstr.begin(), hstr.end());
+      job->stream = new std::ofstream(job->fileName.c_str(), std::ios::out | std::ios::trunc);
+      if( ! job->stream->good()) {
+        BoxLib::FileOpenFailed(job->fileName);
+      }
+
+      bytesWritten += hstr.size();
+      PostAsyncWrite(job);
+    }
+
+    bytesWritten += VisMF::WriteHistograms(mf, mf_name, coordinatorProc);
+
+    asyncWritesPosted = true;
+
+    delete whichRD;
+
+    return bytesWritten;
+}
+
+
+void
+VisMF::WaitForAsyncWrites ()
+{
+    if( ! asyncWritesPosted) {
+      return;
+    }
+
+    BL_PROFILE("VisMF::WaitForAsyncWrites");
+
+    std::string failedFileName;
+    {
+      std::unique_lock<std::mutex> lock(ioMutex);
+      ioCond.wait(lock, [] { return ioQueue.empty() && ! ioBusy; });
+      failedFileName.swap(ioFailedFileName);
+    }
+
+    if( ! failedFileName.empty()) {
+      std::string msg("VisMF::AsyncWrite failed writing ");
+      msg += failedFileName;
+      BoxLib::Error(msg.c_str());
+    }
+
+    ParallelDescriptor::Barrier("VisMF::WaitForAsyncWrites");
+
+    asyncWritesPosted = false;
+}
+
+
 void
-VisMF::FindOffsets (const FabArray<FArrayBox> &mf,
+VisMF::FindOffsets (const FabArrayBase &mf,
 		    const std::string &filePrefix,
                     VisMF::Header &hdr,
 		    bool groupSets,
@@ -1190,8 +2207,14 @@ VisMF::FindOffsets (const FabArray<FArrayBox> &mf,
 	      for(int i(0); i < index.size(); ++i) {
 	        hdr.m_fod[index[i]].m_name = whichFileName;
 	        hdr.m_fod[index[i]].m_head = currentOffset[whichFileNumber];
-	        currentOffset[whichFileNumber] += mf.fabbox(index[i]).numPts() * nComps * whichRDBytes
-	                                          + fabHeaderBytes[index[i]];
+	        if(hdr.m_vers == VisMF::Header::NoFabHeaderCompressed_v1) {
+	          for(int n(0); n < nComps; ++n) {
+	            currentOffset[whichFileNumber] += hdr.m_csize[index[i]][n];
+	          }
+	        } else {
+	          currentOffset[whichFileNumber] += mf.fabbox(index[i]).numPts() * nComps * whichRDBytes
+	                                            + fabHeaderBytes[index[i]];
+	        }
 	      }
 	    }
 	  }
@@ -1217,6 +2240,10 @@ VisMF::RemoveFiles(const std::string &mf_name, bool verbose)
 	            << strerror(errno) << std::endl;
         }
       }
+      std::string histFileName(mf_name + HistogramFileSuffix);
+      if(std::remove(histFileName.c_str()) == 0 && verbose) {  // ---- it is optional
+        std::cout << "---- removed:  " << histFileName << std::endl;
+      }
       for(int ip(0); ip < nOutFiles; ++ip) {
         std::string fileName(NFilesIter::FileName(nOutFiles, mf_name + FabFileSuffix, ip, true));
         if(verbose) {
@@ -1248,6 +2275,33 @@ VisMF::VisMF (const std::string &fafab_name)
     std::istringstream infs(fileCharPtrString, std::istringstream::in);
 
     infs >> m_hdr;
+    //
+    // The histograms are optional.
+    //
+    Array<char> histCharPtr;
+    ParallelDescriptor::ReadAndBcastFile(m_fafabname + HistogramFileSuffix, histCharPtr, false);
+    if(histCharPtr.size() > 0) {
+      std::istringstream hists(std::string(histCharPtr.dataPtr()), std::istringstream::in);
+      int nBoxes(0), nComps(0), nBins(0);
+      hists >> nBoxes >> nComps >> nBins;
+      if(nBoxes == m_hdr.m_ba.size() && nComps == m_hdr.m_ncomp && nBins > 0) {
+        m_hist.resize(nBoxes);
+        for(int i(0); i < nBoxes; ++i) {
+          m_hist[i].resize(nComps);
+          for(int n(0); n < nComps; ++n) {
+            Histogram &h = m_hist[i][n];
+            h.count.resize(nBins);
+            hists >> h.lo >> h.hi;
+            for(int b(0); b < nBins; ++b) {
+              hists >> h.count[b];
+            }
+          }
+        }
+      }
+      if( ! hists.good()) {  // ---- not ours or damaged, do without
+        m_hist.clear();
+      }
+    }
 
     m_pa.resize(m_hdr.m_ncomp);
 
@@ -1263,6 +2317,15 @@ VisMF::VisMF (const std::string &fafab_name)
 
 VisMF::~VisMF ()
 {
+#ifndef WIN32
+    for(std::map<std::string, MappedFile>::iterator mfIter = m_mapped.begin();
+        mfIter != m_mapped.end(); ++mfIter)
+    {
+      if(mfIter->second.data != 0) {
+        munmap(mfIter->second.data, mfIter->second.size);
+      }
+    }
+#endif
 }
 
 
@@ -1292,6 +2355,16 @@ VisMF::readFAB (int                  idx,
       } else {
         fab->readFrom(*infs, whichComp);
       }
+    } else if(hdr.m_vers == Header::NoFabHeaderCompressed_v1) {
+      const Array<long> &csize = hdr.m_csize[idx];
+      const int firstComp(whichComp == -1 ? 0 : whichComp);
+      long skipBytes(0);
+      for(int n(0); n < firstComp; ++n) {
+        skipBytes += csize[n];
+      }
+      infs->seekg(skipBytes, std::ios::cur);
+      ReadCompressed(*infs, fab->dataPtr(), fab->box().numPts(), csize,
+                     firstComp, fab->nComp(), hdr.m_writtenRD);
     } else {
       if(whichComp == -1) {    // ---- read all components
 	if(hdr.m_writtenRD == FPC::NativeRealDescriptor()) {
@@ -1336,17 +2409,7 @@ VisMF::readFAB (FabArray<FArrayBox> &mf,
     std::ifstream *infs = VisMF::OpenStream(FullName);
     infs->seekg(hdr.m_fod[idx].m_head, std::ios::beg);
 
-    if(NoFabHeader(hdr)) {
-      if(hdr.m_writtenRD == FPC::NativeRealDescriptor()) {
-        infs->read((char *) fab.dataPtr(), fab.nBytes());
-      } else {
-        long readDataItems(fab.box().numPts() * fab.nComp());
-        RealDescriptor::convertToNativeFormat(fab.dataPtr(), readDataItems,
-	                                      *infs, hdr.m_writtenRD);
-      }
-    } else {
-      fab.readFrom(*infs);
-    }
+    ReadFabFrom(*infs, fab, hdr, idx);
 
     VisMF::CloseStream(FullName);
 }
@@ -1360,6 +2423,8 @@ VisMF::Read (FabArray<FArrayBox> &mf,
 {
     BL_PROFILE("VisMF::Read()");
 
+    VisMF::WaitForAsyncWrites();
+
     VisMF::Header hdr;
     Real hEndTime, hStartTime, faCopyTime(0.0);
     Real startTime(ParallelDescriptor::second());
@@ -1399,7 +2464,13 @@ VisMF::Read (FabArray<FArrayBox> &mf,
 
 #ifdef BL_USE_MPI
 
-  if(noFabHeader && useSynchronousReads) {
+  if(useAggregatedReads) {
+
+    VisMF::ReadAggregated(mf, mf_name, hdr, coordinatorProc);
+
+  } else if(noFabHeader && useSynchronousReads &&
+            hdr.m_vers != VisMF::Header::NoFabHeaderCompressed_v1)
+  {
 
     // ---- This code is only for reading in file order
     bool doConvert(hdr.m_writtenRD != FPC::NativeRealDescriptor());
@@ -1787,6 +2858,223 @@ VisMF::Read (FabArray<FArrayBox> &mf,
 }
 
 
+#ifdef BL_USE_MPI
+void
+VisMF::ReadAggregated (FabArray<FArrayBox> &mf,
+                       const std::string   &mf_name,
+                       const VisMF::Header &hdr,
+		       int                  coordinatorProc)
+{
+    BL_PROFILE("VisMF::ReadAggregated");
+
+    const int myProc(ParallelDescriptor::MyProc());
+    const int nProcs(ParallelDescriptor::NProcs());
+    const int nBoxes(hdr.m_ba.size());
+    const bool noFabHeader(NoFabHeader(hdr));
+    const bool compressed(hdr.m_vers == VisMF::Header::NoFabHeaderCompressed_v1);
+    const bool isNative(hdr.m_writtenRD == FPC::NativeRealDescriptor());
+    const DistributionMapping &dm = mf.DistributionMap();
+    const std::string dirName(VisMF::DirName(mf_name));
+
+    if(nBoxes == 0) {
+      return;
+    }
+
+    // ---- the fabs in file order
+    Array<int> fileOrder(nBoxes);
+    for(int i(0); i < nBoxes; ++i) {
+      fileOrder[i] = i;
+    }
+    std::sort(fileOrder.begin(), fileOrder.end(), [&hdr] (int a, int b)
+              { return hdr.m_fod[a].m_name < hdr.m_fod[b].m_name ||
+                       (hdr.m_fod[a].m_name == hdr.m_fod[b].m_name &&
+                        hdr.m_fod[a].m_head < hdr.m_fod[b].m_head); } );
+
+    // ---- the extent of each fab on disk
+    Array<long> fabBytes(nBoxes);
+    Array<int> lastInFile;    // ---- [file](position in fileOrder)
+    for(int j(0); j < nBoxes; ++j) {
+      const int i(fileOrder[j]);
+      if(compressed) {
+        fabBytes[i] = 0;
+        for(int n(0); n < hdr.m_ncomp; ++n) {
+          fabBytes[i] += hdr.m_csize[i][n];
+        }
+      } else if(noFabHeader) {
+        fabBytes[i] = BoxLib::grow(hdr.m_ba[i], hdr.m_ngrow).numPts() * hdr.m_ncomp
+                      * hdr.m_writtenRD.numBytes();
+      } else if(j + 1 < nBoxes && hdr.m_fod[fileOrder[j + 1]].m_name == hdr.m_fod[i].m_name) {
+        fabBytes[i] = hdr.m_fod[fileOrder[j + 1]].m_head - hdr.m_fod[i].m_head;
+      }
+      if(j + 1 == nBoxes || hdr.m_fod[fileOrder[j + 1]].m_name != hdr.m_fod[i].m_name) {
+        lastInFile.push_back(j);
+      }
+    }
+    const int nFiles(lastInFile.size());
+
+    if( ! noFabHeader) {
+      // ---- the fab headers vary in length:  the last fab in a file ends
+      // ---- at the end of the file
+      Array<long> fileSizes(lastInFile.size(), 0L);
+      if(myProc == coordinatorProc) {
+        for(int k(0); k < lastInFile.size(); ++k) {
+          std::string fullName(dirName + hdr.m_fod[fileOrder[lastInFile[k]]].m_name);
+          std::ifstream ifs(fullName.c_str(), std::ios::in | std::ios::binary);
+          if( ! ifs.good()) {
+            BoxLib::FileOpenFailed(fullName);
+          }
+          ifs.seekg(0, std::ios::end);
+          fileSizes[k] = ifs.tellg();
+        }
+      }
+      ParallelDescriptor::Bcast(fileSizes.dataPtr(), fileSizes.size(), coordinatorProc);
+      for(int k(0); k < lastInFile.size(); ++k) {
+        const int i(fileOrder[lastInFile[k]]);
+        fabBytes[i] = fileSizes[k] - hdr.m_fod[i].m_head;
+      }
+    }
+
+    // ---- aggregator a reads the fabs starting in its share of the bytes
+    const int nAgg(std::max(1, std::min(nProcs, nReadAggregators > 0 ? nReadAggregators : nFiles)));
+    double totalBytes(0.0);
+    for(int i(0); i < nBoxes; ++i) {
+      totalBytes += fabBytes[i];
+    }
+
+    Array<int> readRank(nBoxes);
+    int myFirst(nBoxes), myLast(-1);    // ---- [myFirst, myLast] in fileOrder
+    double startByte(0.0);
+    for(int j(0); j < nBoxes; ++j) {
+      const int i(fileOrder[j]);
+      const int a(std::min(nAgg - 1, static_cast<int>(nAgg * startByte / totalBytes)));
+      readRank[i] = static_cast<int>((static_cast<long>(a) * nProcs) / nAgg);
+      if(readRank[i] == myProc) {
+        myFirst = std::min(myFirst, j);
+        myLast  = j;
+      }
+      startByte += fabBytes[i];
+    }
+
+    // ---- post the receives for this rank's fabs, in file order
+    const int readTag(ParallelDescriptor::SeqNum());
+    const bool directRecv(noFabHeader && isNative && ! compressed);
+    std::vector<MPI_Request> recvReqs;
+    std::map<int, std::vector<char> > recvBuffers;    // ---- [fab index]
+
+    for(int j(0); j < nBoxes; ++j) {
+      const int i(fileOrder[j]);
+      if(dm[i] == myProc && readRank[i] != myProc) {
+        BL_ASSERT(fabBytes[i] <= std::numeric_limits<int>::max());
+        char *dest;
+        if(directRecv) {
+          dest = (char *) mf[i].dataPtr();
+        } else {
+          recvBuffers[i].resize(fabBytes[i]);
+          dest = recvBuffers[i].data();
+        }
+        recvReqs.push_back(MPI_REQUEST_NULL);
+        BL_MPI_REQUIRE( MPI_Irecv(dest, fabBytes[i], MPI_CHAR, readRank[i], readTag,
+                                  ParallelDescriptor::Communicator(), &recvReqs.back()) );
+      }
+    }
+
+    // ---- read contiguous runs of fabs and send them to their owners,
+    // ---- alternating two buffers so reading overlaps sending.  a run is
+    // ---- read in order, with this rank's own fabs read in place
+    std::vector<char> readBuffer[2];
+    std::vector<MPI_Request> sendReqs[2];
+    std::ifstream ifs;
+    std::string openFileName;
+    int whichBuffer(0);
+
+    for(int jStart(myFirst); jStart <= myLast; ) {
+      long nBytes(fabBytes[fileOrder[jStart]]);
+      int jEnd(jStart + 1);
+      while(jEnd <= myLast) {
+        const int prev(fileOrder[jEnd - 1]), next(fileOrder[jEnd]);
+        if(hdr.m_fod[next].m_name != hdr.m_fod[prev].m_name ||
+           hdr.m_fod[next].m_head != hdr.m_fod[prev].m_head + fabBytes[prev] ||
+           nBytes + fabBytes[next] > aggReadSize)
+        {
+          break;
+        }
+        nBytes += fabBytes[next];
+        ++jEnd;
+      }
+
+      std::vector<MPI_Request> &reqs = sendReqs[whichBuffer];
+      if( ! reqs.empty()) {
+        BL_MPI_REQUIRE( MPI_Waitall(reqs.size(), reqs.data(), MPI_STATUSES_IGNORE) );
+        reqs.clear();
+      }
+      long sendBytes(0);
+      for(int j(jStart); j < jEnd; ++j) {
+        if(dm[fileOrder[j]] != myProc) {
+          sendBytes += fabBytes[fileOrder[j]];
+        }
+      }
+      std::vector<char> &buffer = readBuffer[whichBuffer];
+      if(buffer.size() < sendBytes) {
+        buffer.resize(sendBytes);
+      }
+
+      const std::string fullName(dirName + hdr.m_fod[fileOrder[jStart]].m_name);
+      if(fullName != openFileName) {
+        if(ifs.is_open()) {
+          ifs.close();
+        }
+        ifs.clear();
+        ifs.open(fullName.c_str(), std::ios::in | std::ios::binary);
+        if( ! ifs.good()) {
+          BoxLib::FileOpenFailed(fullName);
+        }
+        openFileName = fullName;
+      }
+      long position(0);
+      for(int j(jStart); j < jEnd; ++j) {
+        const int i(fileOrder[j]);
+        if(ifs.tellg() != hdr.m_fod[i].m_head) {
+          ifs.seekg(hdr.m_fod[i].m_head, std::ios::beg);
+        }
+        if(dm[i] == myProc) {
+          ReadFabFrom(ifs, mf[i], hdr, i);
+        } else {
+          char *fabData = buffer.data() + position;
+          ifs.read(fabData, fabBytes[i]);
+          reqs.push_back(MPI_REQUEST_NULL);
+          BL_MPI_REQUIRE( MPI_Isend(fabData, fabBytes[i], MPI_CHAR, dm[i], readTag,
+                                    ParallelDescriptor::Communicator(), &reqs.back()) );
+          position += fabBytes[i];
+        }
+      }
+      if( ! ifs.good()) {
+        BoxLib::Error(("VisMF::ReadAggregated failed reading " + fullName).c_str());
+      }
+
+      jStart = jEnd;
+      whichBuffer = 1 - whichBuffer;
+    }
+
+    for(int b(0); b < 2; ++b) {
+      if( ! sendReqs[b].empty()) {
+        BL_MPI_REQUIRE( MPI_Waitall(sendReqs[b].size(), sendReqs[b].data(), MPI_STATUSES_IGNORE) );
+      }
+    }
+    if( ! recvReqs.empty()) {
+      BL_MPI_REQUIRE( MPI_Waitall(recvReqs.size(), recvReqs.data(), MPI_STATUSES_IGNORE) );
+    }
+
+    for(std::map<int, std::vector<char> >::iterator rbIter = recvBuffers.begin();
+        rbIter != recvBuffers.end(); ++rbIter)
+    {
+      MemoryStreamBuf sbuf(rbIter->second.data(), rbIter->second.size());
+      std::istream is(&sbuf);
+      ReadFabFrom(is, mf[rbIter->first], hdr, rbIter->first);
+    }
+}
+#endif
+
+
 void
 VisMF::ReadFAHeader (const std::string &fafabName,
 	             Array<char> &faHeader)
@@ -1909,9 +3197,10 @@ VisMF::clear ()
 
 
 bool VisMF::NoFabHeader(const VisMF::Header &hdr) {
-  if(hdr.m_vers == VisMF::Header::NoFabHeader_v1       ||
-    hdr.m_vers == VisMF::Header::NoFabHeaderMinMax_v1 ||
-    hdr.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1)
+  if(hdr.m_vers == VisMF::Header::NoFabHeader_v1         ||
+    hdr.m_vers == VisMF::Header::NoFabHeaderMinMax_v1   ||
+    hdr.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1 ||
+    hdr.m_vers == VisMF::Header::NoFabHeaderCompressed_v1)
   {
     return true;
   }
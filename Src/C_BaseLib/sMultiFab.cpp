@@ -0,0 +1,233 @@
+
+#include <winstd.H>
+#include <algorithm>
+#include <limits>
+
+#include <BLassert.H>
+#include <sMultiFab.H>
+#include <ParallelDescriptor.H>
+#include <BLProfiler.H>
+
+namespace
+{
+    bool initialized = false;
+    //
+    // dst(bx,dstcomp:) = src(bx,srccomp:), one pencil along i at a time.
+    //
+    template <class TD, class TS>
+    void
+    convert (BaseFab<TD>&       dst,
+             const BaseFab<TS>& src,
+             const Box&         bx,
+             int                srccomp,
+             int                dstcomp,
+             int                numcomp)
+    {
+        BL_ASSERT(dst.box().contains(bx) && src.box().contains(bx));
+        BL_ASSERT(srccomp >= 0 && srccomp+numcomp <= src.nComp());
+        BL_ASSERT(dstcomp >= 0 && dstcomp+numcomp <= dst.nComp());
+
+        Box pencils(bx);
+        pencils.setBig(0, bx.smallEnd(0));
+
+        const int nx = bx.length(0);
+
+        for (int n = 0; n < numcomp; ++n)
+        {
+            for (IntVect iv = pencils.smallEnd(); iv <= pencils.bigEnd(); pencils.next(iv))
+            {
+                TD*       d = dst.dataPtr(dstcomp+n) + dst.box().index(iv);
+                const TS* s = src.dataPtr(srccomp+n) + src.box().index(iv);
+
+                for (int i = 0; i < nx; ++i)
+                    d[i] = static_cast<TD>(s[i]);
+            }
+        }
+    }
+}
+
+void
+sMultiFab::Initialize ()
+{
+    if (initialized) return;
+
+    BoxLib::ExecOnFinalize(sMultiFab::Finalize);
+
+    initialized = true;
+}
+
+void
+sMultiFab::Finalize ()
+{
+    initialized = false;
+}
+
+sMultiFab::sMultiFab () {}
+
+sMultiFab::sMultiFab (const BoxArray& bxs,
+                      int             ncomp,
+                      int             ngrow,
+                      FabAlloc        alloc)
+    :
+    FabArray<BaseFab<float> >(bxs,ncomp,ngrow,alloc)
+{
+}
+
+sMultiFab::sMultiFab (const BoxArray&            bxs,
+                      int                        ncomp,
+                      int                        ngrow,
+                      const DistributionMapping& dm,
+                      FabAlloc                   alloc)
+    :
+    FabArray<BaseFab<float> >(bxs,ncomp,ngrow,dm,alloc)
+{
+}
+
+void
+sMultiFab::operator= (const float& r)
+{
+    setVal(r);
+}
+
+Real
+sMultiFab::min (int comp,
+                int nghost,
+                bool local) const
+{
+    BL_ASSERT(nghost >= 0 && nghost <= n_grow);
+
+    Real mn = std::numeric_limits<Real>::max();
+
+#ifdef _OPENMP
+#pragma omp parallel reduction(min:mn)
+#endif
+    for (MFIter mfi(*this,true); mfi.isValid(); ++mfi)
+    {
+	const Box& bx = mfi.growntilebox(nghost);
+	mn = std::min(mn,Real(get(mfi).min(bx,comp)));
+    }
+
+    if (!local)
+	ParallelDescriptor::ReduceRealMin(mn, this->color());
+
+    return mn;
+}
+
+Real
+sMultiFab::max (int comp,
+                int nghost,
+                bool local) const
+{
+    BL_ASSERT(nghost >= 0 && nghost <= n_grow);
+
+    Real mx = -std::numeric_limits<Real>::max();
+
+#ifdef _OPENMP
+#pragma omp parallel reduction(max:mx)
+#endif
+    for (MFIter mfi(*this,true); mfi.isValid(); ++mfi)
+    {
+	const Box& bx = mfi.growntilebox(nghost);
+	mx = std::max(mx,Real(get(mfi).max(bx,comp)));
+    }
+
+    if (!local)
+	ParallelDescriptor::ReduceRealMax(mx, this->color());
+
+    return mx;
+}
+
+void
+sMultiFab::Copy (sMultiFab&      dst,
+                 const MultiFab& src,
+                 int             srccomp,
+                 int             dstcomp,
+                 int             numcomp,
+                 int             nghost)
+{
+    BL_ASSERT(dst.boxArray() == src.boxArray());
+    BL_ASSERT(dst.DistributionMap() == src.DistributionMap());
+    BL_ASSERT(dst.nGrow() >= nghost && src.nGrow() >= nghost);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(dst,true); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.growntilebox(nghost);
+
+        if (bx.ok())
+            convert(dst[mfi], src[mfi], bx, srccomp, dstcomp, numcomp);
+    }
+}
+
+void
+sMultiFab::Copy (MultiFab&        dst,
+                 const sMultiFab& src,
+                 int              srccomp,
+                 int              dstcomp,
+                 int              numcomp,
+                 int              nghost)
+{
+    BL_ASSERT(dst.boxArray() == src.boxArray());
+    BL_ASSERT(dst.DistributionMap() == src.DistributionMap());
+    BL_ASSERT(dst.nGrow() >= nghost && src.nGrow() >= nghost);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(dst,true); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.growntilebox(nghost);
+
+        if (bx.ok())
+            convert(dst[mfi], src[mfi], bx, srccomp, dstcomp, numcomp);
+    }
+}
+
+long
+sMultiFab::Write (const sMultiFab&   smf,
+                  const std::string& name,
+                  VisMF::How         how)
+{
+    BL_PROFILE("sMultiFab::Write()");
+    //
+    // VisMF promotes one FAB at a time, and nothing is lost writing the
+    // promoted values back out in 32 bits.
+    //
+    const FABio::Format fmt = FArrayBox::getFormat();
+
+    FArrayBox::setFormat(FABio::FAB_IEEE_32);
+
+    const long nbytes = VisMF::Write(smf, name, how);
+
+    FArrayBox::setFormat(fmt);
+
+    return nbytes;
+}
+
+void
+sMultiFab::Read (sMultiFab&         smf,
+                 const std::string& name)
+{
+    BL_PROFILE("sMultiFab::Read()");
+
+    BL_ASSERT(smf.size() == 0);
+
+    VisMF::WaitForAsyncWrites();
+
+    VisMF vmf(name);
+
+    smf.define(vmf.boxArray(), vmf.nComp(), vmf.nGrow(), Fab_allocate);
+    //
+    // Read and demote one FAB at a time.
+    //
+    for (MFIter mfi(smf); mfi.isValid(); ++mfi)
+    {
+        FArrayBox* fab = vmf.readFAB(mfi.index(), name);
+
+        convert(smf[mfi], *fab, fab->box(), 0, 0, smf.nComp());
+
+        delete fab;
+    }
+}
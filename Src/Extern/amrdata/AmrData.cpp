@@ -142,6 +142,7 @@ extern "C" {
 bool AmrData::verbose = false;
 int  AmrData::skipPltLines  = 0;
 int  AmrData::sBoundaryWidth = 0;
+bool AmrData::useMMap = false;
 
 // ---------------------------------------------------------------
 AmrData::AmrData() {
@@ -1740,8 +1741,14 @@ bool AmrData::DefineFab(int level, int componentIndex, int fabIndex) {
   if( ! dataGridsDefined[level][componentIndex][fabIndex]) {
     int whichVisMF(compIndexToVisMFMap[componentIndex]);
     int whichVisMFComponent(compIndexToVisMFComponentMap[componentIndex]);
-    dataGrids[level][componentIndex]->setFab(fabIndex,
-                visMF[level][whichVisMF]->readFAB(fabIndex, whichVisMFComponent));
+    FArrayBox *fab(0);
+    if(useMMap) {
+      fab = visMF[level][whichVisMF]->mapFAB(fabIndex, whichVisMFComponent);
+    }
+    if(fab == 0) {
+      fab = visMF[level][whichVisMF]->readFAB(fabIndex, whichVisMFComponent);
+    }
+    dataGrids[level][componentIndex]->setFab(fabIndex, fab);
     dataGridsDefined[level][componentIndex][fabIndex] = true;
   }
   return true;
@@ -1981,6 +1988,85 @@ bool AmrData::MinMax(const Box &onBox, const string &derived, int level,
 }  // end MinMax
 
 
+// ---------------------------------------------------------------
+void AmrData::CandidateGrids(int level, const string &varName, Real lo, Real hi,
+                             Array<int> &grids) const
+{
+  BL_ASSERT(level >= 0 && level <= finestLevel);
+
+  int compIndex(StateNumber(varName));
+  grids.clear();
+
+  if(fileType == Amrvis::FAB || (fileType == Amrvis::MULTIFAB && level == 0)) {
+    // no statistics, all grids are candidates
+    for(int i(0); i < fabBoxArray.size(); ++i) {
+      grids.push_back(i);
+    }
+  } else {
+    int whichVisMF(compIndexToVisMFMap[compIndex]);
+    int whichVisMFComponent(compIndexToVisMFComponentMap[compIndex]);
+    const VisMF &vmf = *visMF[level][whichVisMF];
+    for(int i(0); i < vmf.size(); ++i) {
+      if(vmf.mayContain(i, whichVisMFComponent, lo, hi)) {
+        grids.push_back(i);
+      }
+    }
+  }
+}
+
+
+// ---------------------------------------------------------------
+long AmrData::FindCells(int level, const string &varName, Real lo, Real hi,
+                        Array<IntVect> &cells)
+{
+  BL_ASSERT(level >= 0 && level <= finestLevel);
+
+  int compIndex(StateNumber(varName));
+  bool haveStats( ! (fileType == Amrvis::FAB ||
+                     (fileType == Amrvis::MULTIFAB && level == 0)));
+  int nRead(0), nSkipped(0);
+  cells.clear();
+
+  for(MFIter mfi(*dataGrids[level][compIndex]); mfi.isValid(); ++mfi) {
+    int gdx(mfi.index());
+    if(haveStats) {
+      int whichVisMF(compIndexToVisMFMap[compIndex]);
+      int whichVisMFComponent(compIndexToVisMFComponentMap[compIndex]);
+      if( ! visMF[level][whichVisMF]->mayContain(gdx, whichVisMFComponent, lo, hi)) {
+        ++nSkipped;
+        continue;
+      }
+    }
+    DefineFab(level, compIndex, gdx);
+    ++nRead;
+
+    const FArrayBox &fab = (*dataGrids[level][compIndex])[mfi];
+    const Box &vbox = mfi.validbox();
+    for(IntVect iv(vbox.smallEnd()); iv <= vbox.bigEnd(); vbox.next(iv)) {
+      Real value(fab(iv, 0));
+      if(value >= lo && value <= hi) {
+        cells.push_back(iv);
+      }
+    }
+  }
+
+  long nCells(cells.size());
+  ParallelDescriptor::ReduceLongSum(nCells);
+
+  if(verbose) {
+    ParallelDescriptor::ReduceIntSum(nRead);
+    ParallelDescriptor::ReduceIntSum(nSkipped);
+    if(ParallelDescriptor::IOProcessor()) {
+      cout << "AmrData::FindCells:  level " << level << "  " << varName
+           << " in [" << lo << ", " << hi << "]:  " << nCells << " cells, "
+           << nRead << " grids read, " << nSkipped << " grids skipped" << endl;
+    }
+  }
+
+  return nCells;
+}
+
+
 // ---------------------------------------------------------------
 int AmrData::StateNumber(const string &statename) const {
   for(int ivar(0); ivar < plotVars.size(); ++ivar) {
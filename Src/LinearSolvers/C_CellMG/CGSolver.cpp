@@ -203,6 +203,30 @@ sxay (MultiFab&       ss,
     sxay(ss,xx,a,yy,0);
 }
 
+//
+// xx += a*pp and yy = zz + b*qq in one pass, returning the inf norms of
+// the new xx and yy with one reduction.
+//
+static
+void
+sxay2 (MultiFab&       xx,
+       Real            a,
+       const MultiFab& pp,
+       MultiFab&       yy,
+       const MultiFab& zz,
+       Real            b,
+       const MultiFab& qq,
+       Real&           xxnorm,
+       Real&           yynorm)
+{
+    BL_PROFILE("CGSolver::sxay2()");
+
+    Real nrm[2];
+    MultiFab::Saxpy2(xx, a, pp, yy, zz, b, qq, 0, 1, nrm);
+    xxnorm = nrm[0];
+    yynorm = nrm[1];
+}
+
 //
 // Do a one-component dot product of r & z using supplied components.
 //
@@ -937,10 +961,7 @@ CGSolver::solve_bicgstab (MultiFab&       sol,
 	{
             ret = 2; break;
 	}
-        sxay(sol, sol,  alpha, ph);
-        sxay(s,     r, -alpha,  v);
-
-        rnorm = norm_inf(s);
+        sxay2(sol, alpha, ph, s, r, -alpha, v, sol_norm, rnorm);
 
         if ( verbose > 2 && ParallelDescriptor::IOProcessor(color()) )
         {
@@ -954,7 +975,6 @@ CGSolver::solve_bicgstab (MultiFab&       sol,
 #ifdef CG_USE_OLD_CONVERGENCE_CRITERIA
         if ( rnorm < eps_rel*rnorm0 || rnorm < eps_abs ) break;
 #else
-        sol_norm = norm_inf(sol);
         if ( rnorm < eps_rel*(Lp_norm*sol_norm + rnorm0 ) || rnorm < eps_abs ) break;
 #endif
         if ( use_mg_precond )
@@ -973,13 +993,13 @@ CGSolver::solve_bicgstab (MultiFab&       sol,
         }
         Lp.apply(t, sh, lev, temp_bc_mode);
         //
-        // This is a little funky.  I want to elide one of the reductions
-        // in the following two dotxy()s.  We do that by calculating the "local"
-        // values and then reducing the two local values at the same time.
+        // t.t and t.s in one pass over t with one reduction.
         //
-        Real vals[2] = { dotxy(t,t,true), dotxy(t,s,true) };
+        Array<const MultiFab*> xs(2, &t), ys(2);
+        ys[0] = &t;
+        ys[1] = &s;
 
-        ParallelDescriptor::ReduceRealSum(vals,2,color());
+        const Array<Real> vals = MultiFab::Dot(xs, 0, ys, 0, 1, 0);
 
         if ( vals[0] )
 	{
@@ -989,10 +1009,7 @@ CGSolver::solve_bicgstab (MultiFab&       sol,
 	{
             ret = 3; break;
 	}
-        sxay(sol, sol,  omega, sh);
-        sxay(r,     s, -omega,  t);
-
-        rnorm = norm_inf(r);
+        sxay2(sol, omega, sh, r, s, -omega, t, sol_norm, rnorm);
 
         if ( verbose > 2 && ParallelDescriptor::IOProcessor(color()) )
         {
@@ -1006,7 +1023,6 @@ CGSolver::solve_bicgstab (MultiFab&       sol,
 #ifdef CG_USE_OLD_CONVERGENCE_CRITERIA
         if ( rnorm < eps_rel*rnorm0 || rnorm < eps_abs ) break;
 #else
-        sol_norm = norm_inf(sol);
         if ( rnorm < eps_rel*(Lp_norm*sol_norm + rnorm0 ) || rnorm < eps_abs ) break;
 #endif
         if ( omega == 0 )
@@ -1159,10 +1175,7 @@ CGSolver::solve_cg (MultiFab&       sol,
                       << " rho " << rho
                       << " alpha " << alpha << '\n';
         }
-        sxay(sol, sol, alpha, p);
-        sxay(  r,   r,-alpha, q);
-        rnorm = norm_inf(r);
-        sol_norm = norm_inf(sol);
+        sxay2(sol, alpha, p, r, r, -alpha, q, sol_norm, rnorm);
 
         if ( verbose > 2 && ParallelDescriptor::IOProcessor(color()) )
         {
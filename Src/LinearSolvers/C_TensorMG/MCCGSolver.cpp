@@ -266,8 +266,7 @@ MCCGSolver::solve (MultiFab&       sol,
 	// x += alpha p  and  r -= alpha w
         //
 	rhoold = rho;
-	update( sol, alpha, r, p, w );
-	rnorm = norm(r);
+	rnorm = update( sol, alpha, r, p, w );
         if (rnorm > def_unstable_criterion*minrnorm)
         {
             ret = 2;
@@ -328,7 +327,7 @@ MCCGSolver::advance (MultiFab&       p,
     MultiFab::Xpay(p, beta, z, 0, 0, ncomp, nghost);
 }
 
-void
+Real
 MCCGSolver::update (MultiFab&       sol,
 		    Real            alpha,
 		    MultiFab&       r,
@@ -336,11 +335,12 @@ MCCGSolver::update (MultiFab&       sol,
 		    const MultiFab& w)
 {
     //
-    // Compute sol =+ alpha p  and  r -= alpha w
+    // Compute sol =+ alpha p  and  r -= alpha w, and the max-norm of r
     //
     int ncomp = r.nComp();
-    MultiFab::Saxpy(sol,  alpha, p, 0, 0, ncomp, 0);
-    MultiFab::Saxpy(r  , -alpha, w, 0, 0, ncomp, 0);
+    Real nrm[2];
+    MultiFab::Saxpy2(sol, alpha, p, r, r, -alpha, w, 0, ncomp, nrm);
+    return nrm[1];
 }
 
 Real
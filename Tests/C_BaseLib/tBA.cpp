@@ -2,8 +2,13 @@
 #include <fstream>
 #include <BoxArray.H>
 #include <BoxDomain.H>
+#include <DistributionMapping.H>
 #include <ParallelDescriptor.H>
 #include <map>
+#include <list>
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
 
 static
 BoxArray
@@ -262,6 +267,537 @@ newComplementIn_old (const Box&     b,
     return newb;
 }
 
+//
+// The std::list based complementIn() and simplify() that BoxList used to
+// have, to time and check the vector based ones against.
+//
+static
+BoxList
+complementIn_list (const Box&     b,
+                   const BoxList& bl)
+{
+    BoxList result(b.ixType());
+
+    Box     mbox = bl.minimalBox();
+    BoxList diff = BoxLib::boxDiff(b,mbox);
+    result.catenate(diff);
+
+    BoxArray ba(bl);
+
+    BoxList mesh(b.ixType());
+    if (mbox.ok())
+        mesh.push_back(mbox);
+    mesh.maxSize(BL_SPACEDIM == 3 ? 64 : 128);
+
+    std::vector< std::pair<int,Box> > isects;
+
+    for (BoxList::const_iterator bli = mesh.begin(); bli != mesh.end(); ++bli)
+    {
+        const Box& bx = *bli & b;
+
+        if (!bx.ok()) continue;
+
+        ba.intersections(bx,isects);
+
+        std::list<Box> lb(1,bx);
+
+        for (int i = 0; i < isects.size() && !lb.empty(); i++)
+        {
+            for (std::list<Box>::iterator it = lb.begin(); it != lb.end(); )
+            {
+                if (it->intersects(isects[i].second))
+                {
+                    BoxList tm = BoxLib::boxDiff(*it, isects[i].second);
+                    lb.insert(lb.begin(), tm.begin(), tm.end());
+                    lb.erase(it++);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+
+        for (std::list<Box>::const_iterator it = lb.begin(); it != lb.end(); ++it)
+            result.push_back(*it);
+    }
+
+    return result;
+}
+
+static
+int
+simplify_list (BoxList& bl)
+{
+    std::list<Box> lb(bl.begin(), bl.end());
+
+    lb.sort([](const Box& lhs, const Box& rhs) { return lhs.smallEnd().lexLT(rhs.smallEnd()); });
+
+    int count = 0, lo[BL_SPACEDIM], hi[BL_SPACEDIM];
+
+    for (std::list<Box>::iterator bla = lb.begin(); bla != lb.end(); )
+    {
+        const int* alo   = bla->loVect();
+        const int* ahi   = bla->hiVect();
+        bool       match = false;
+        std::list<Box>::iterator blb = bla;
+        ++blb;
+
+        for (int cnt = 0; blb != lb.end() && cnt < 100; cnt++)
+        {
+            const int* blo = blb->loVect();
+            const int* bhi = blb->hiVect();
+
+            bool canjoin = true;
+            int  joincnt = 0;
+            for (int i = 0; i < BL_SPACEDIM; i++)
+            {
+                if (alo[i]==blo[i] && ahi[i]==bhi[i])
+                {
+                    lo[i] = alo[i]; hi[i] = ahi[i];
+                }
+                else if (alo[i]<=blo[i] && blo[i]<=ahi[i]+1)
+                {
+                    lo[i] = alo[i]; hi[i] = std::max(ahi[i],bhi[i]); joincnt++;
+                }
+                else if (blo[i]<=alo[i] && alo[i]<=bhi[i]+1)
+                {
+                    lo[i] = blo[i]; hi[i] = std::max(ahi[i],bhi[i]); joincnt++;
+                }
+                else
+                {
+                    canjoin = false;
+                    break;
+                }
+            }
+            if (canjoin && (joincnt <= 1))
+            {
+                blb->setSmall(IntVect(lo));
+                blb->setBig(IntVect(hi));
+                lb.erase(bla++);
+                count++;
+                match = true;
+                break;
+            }
+            ++blb;
+        }
+        if (!match)
+            ++bla;
+    }
+
+    bl.clear();
+    for (std::list<Box>::const_iterator it = lb.begin(); it != lb.end(); ++it)
+        bl.push_back(*it);
+
+    return count;
+}
+
+static
+void
+SetOpsBenchmark (const BoxArray& ba)
+{
+    Box bb = ba.minimalBox();
+    bb.grow(4);
+
+    const BoxList bl = ba.boxList();
+
+    Real beg = ParallelDescriptor::second();
+    BoxList bl1 = complementIn_list(bb, bl);
+    Real t_old = ParallelDescriptor::second() - beg;
+
+    beg = ParallelDescriptor::second();
+    BoxList bl2 = BoxLib::complementIn(bb, bl);
+    Real t_new = ParallelDescriptor::second() - beg;
+
+    beg = ParallelDescriptor::second();
+    BoxArray ba3 = BoxLib::complementIn(bb, ba);
+    Real t_ba = ParallelDescriptor::second() - beg;
+
+    std::cout << "complementIn: list " << t_old << ", vector " << t_new
+              << ", BoxArray " << t_ba << " seconds, sizes "
+              << bl1.size() << ' ' << bl2.size() << ' ' << ba3.size() << std::endl;
+
+    BoxArray nba1(bl1), nba2(bl2);
+
+    if (nba1.numPts() == nba2.numPts() && nba2.numPts() == ba3.numPts() &&
+        nba1.contains(nba2) && nba2.contains(nba1) && nba1.contains(ba3))
+        std::cout << "    all three cover the same area" << std::endl;
+    else
+        std::cout << "    the complements do NOT cover the same area" << std::endl;
+
+    BoxList sl1(bl1), sl2(bl1);
+
+    beg = ParallelDescriptor::second();
+    simplify_list(sl1);
+    t_old = ParallelDescriptor::second() - beg;
+
+    beg = ParallelDescriptor::second();
+    sl2.simplify();
+    t_new = ParallelDescriptor::second() - beg;
+
+    std::cout << "simplify: list " << t_old << ", vector " << t_new << " seconds, "
+              << (sl1 == sl2 ? "same result" : "DIFFERENT results") << ", size "
+              << sl2.size() << std::endl;
+
+    beg = ParallelDescriptor::second();
+    BoxList gc = BoxLib::GetBndryCells(ba, 1);
+    std::cout << "GetBndryCells: " << ParallelDescriptor::second() - beg
+              << " seconds, size " << gc.size() << std::endl;
+
+    BoxList grown(bl);
+    grown.accrete(1);
+
+    beg = ParallelDescriptor::second();
+    BoxList ro = BoxLib::removeOverlap(grown);
+    std::cout << "removeOverlap: " << ParallelDescriptor::second() - beg
+              << " seconds, size " << ro.size() << std::endl;
+}
+
+//
+// A random BoxArray of nboxes overlapping boxes in [lo,lo+extent)^D, each
+// up to maxlen cells long, and random query boxes over a slightly larger
+// region.
+//
+static
+Box
+RandomBox (int lo, int extent, int maxlen)
+{
+    IntVect small, big;
+
+    for (int d = 0; d < BL_SPACEDIM; ++d)
+    {
+        small[d] = lo - 2 + std::rand() % (extent + 4);
+        big[d]   = small[d] + std::rand() % maxlen;
+    }
+
+    return Box(small, big);
+}
+
+static
+BoxArray
+RandomBoxArray (int nboxes, int lo, int extent, int maxlen)
+{
+    BoxList bl;
+
+    for (int i = 0; i < nboxes; ++i)
+        bl.push_back(RandomBox(lo, extent, maxlen));
+
+    return BoxArray(bl);
+}
+//
+// The intersections of bx with each box of ba grown by ng, by brute force.
+//
+static
+std::vector< std::pair<int,Box> >
+BruteIntersections (const BoxArray& ba, const Box& bx, int ng)
+{
+    std::vector< std::pair<int,Box> > isects;
+
+    for (int i = 0; i < ba.size(); ++i)
+    {
+        const Box isect = BoxLib::grow(ba[i],ng) & bx;
+
+        if (isect.ok())
+            isects.push_back(std::make_pair(i,isect));
+    }
+
+    return isects;
+}
+
+static
+bool
+IsectLess (const std::pair<int,Box>& a, const std::pair<int,Box>& b)
+{
+    if (a.first != b.first)
+        return a.first < b.first;
+    if (a.second.smallEnd() != b.second.smallEnd())
+        return a.second.smallEnd().lexLT(b.second.smallEnd());
+    return a.second.bigEnd().lexLT(b.second.bigEnd());
+}
+
+static
+bool
+SameIntersections (std::vector< std::pair<int,Box> > a,
+                   std::vector< std::pair<int,Box> > b)
+{
+    std::sort(a.begin(), a.end(), IsectLess);
+    std::sort(b.begin(), b.end(), IsectLess);
+    return a == b;
+}
+//
+// Compare intersects(), intersections() and the batched intersections()
+// with brute force.  Returns the number of mismatches.
+//
+static
+int
+CheckIntersections (const BoxArray& ba, const Array<Box>& queries)
+{
+    int nerrors = 0;
+
+    for (int ng = 0; ng <= 2; ++ng)
+    {
+        Array< std::vector< std::pair<int,Box> > > batched;
+
+        ba.intersections(queries, batched, ng);
+
+        if (batched.size() != queries.size())
+            return ++nerrors;
+
+        for (int q = 0; q < queries.size(); ++q)
+        {
+            const std::vector< std::pair<int,Box> > brute = BruteIntersections(ba, queries[q], ng);
+
+            std::vector< std::pair<int,Box> > single;
+
+            ba.intersections(queries[q], single, false, ng);
+
+            if (!SameIntersections(brute, batched[q]) ||
+                !SameIntersections(brute, single)     ||
+                ba.intersects(queries[q], ng) == brute.empty())
+            {
+                ++nerrors;
+            }
+        }
+    }
+
+    return nerrors;
+}
+//
+// removeOverlap() must leave disjoint boxes covering the same cells.
+// Returns the number of errors.
+//
+static
+int
+CheckRemoveOverlap (const BoxArray& ba)
+{
+    BoxArray ro(ba);
+
+    ro.removeOverlap();
+
+    int nerrors = 0;
+
+    for (int i = 0; i < ro.size(); ++i)
+    {
+        if (!ro[i].ok())
+            ++nerrors;
+
+        for (int j = i+1; j < ro.size(); ++j)
+            if (ro[i].intersects(ro[j]))
+                ++nerrors;
+    }
+
+    const Box bb = ba.minimalBox();
+
+    for (IntVect iv = bb.smallEnd(); iv <= bb.bigEnd(); bb.next(iv))
+    {
+        int in_ba = 0, in_ro = 0;
+
+        for (int i = 0; i < ba.size() && in_ba == 0; ++i)
+            in_ba += ba[i].contains(iv);
+
+        for (int i = 0; i < ro.size(); ++i)
+            in_ro += ro[i].contains(iv);
+
+        if (in_ba != in_ro)
+            ++nerrors;
+    }
+
+    return nerrors;
+}
+//
+// Check intersections and removeOverlap() against brute force on random
+// overlapping BoxArrays, cell-centered and nodal, and on a few boxes
+// scattered over a large domain, for which the hash bins are coarsened.
+//
+static
+int
+CheckAgainstBruteForce ()
+{
+    std::srand(12345);
+
+    int nerrors = 0, nchecks = 0;
+
+    for (int trial = 0; trial < 20; ++trial)
+    {
+        BoxArray ba = RandomBoxArray(5 + std::rand() % 60, -8, 24, 9);
+
+        Array<Box> queries(200);
+
+        for (int q = 0; q < queries.size(); ++q)
+            queries[q] = RandomBox(-8, 28, 12);
+
+        nerrors += CheckIntersections(ba, queries);
+        nerrors += CheckRemoveOverlap(ba);
+
+        ba.surroundingNodes();
+
+        for (int q = 0; q < queries.size(); ++q)
+            queries[q].surroundingNodes();
+
+        nerrors += CheckIntersections(ba, queries);
+
+        ++nchecks;
+    }
+
+    for (int trial = 0; trial < 5; ++trial)
+    {
+        const BoxArray ba = RandomBoxArray(8, -50000, 100000, 40);
+
+        Array<Box> queries(2*ba.size());
+
+        for (int q = 0; q < ba.size(); ++q)
+        {
+            queries[2*q]   = BoxLib::grow(ba[q], 3);
+            queries[2*q+1] = RandomBox(-50000, 100000, 5000);
+        }
+
+        nerrors += CheckIntersections(ba, queries);
+        nerrors += CheckRemoveOverlap(RandomBoxArray(8, -50, 100, 40));
+
+        ++nchecks;
+    }
+
+    std::cout << "BoxArray against brute force: " << nchecks << " BoxArrays, "
+              << nerrors << " errors" << std::endl;
+
+    return nerrors;
+}
+
+//
+// The boxes of ba must be those in ref, read in order, backwards, in a
+// scattered order and from OpenMP threads.  Returns the number of errors.
+//
+static
+int
+SameBoxes (const BoxArray& ba, const Array<Box>& ref)
+{
+    const int N = ref.size();
+
+    if (ba.size() != N)
+        return 1;
+
+    int nerrors = 0;
+
+    for (int i = 0; i < N; ++i)
+        nerrors += (ba[i] != ref[i]);
+
+    for (int i = N-1; i >= 0; --i)
+        nerrors += (ba[i] != ref[i]);
+
+    for (int i = 0; i < N; ++i)
+        nerrors += (ba[(37L*i) % N] != ref[(37L*i) % N]);
+
+#ifdef _OPENMP
+#pragma omp parallel for reduction(+:nerrors)
+#endif
+    for (int i = 0; i < 4*N; ++i)
+    {
+        const int k = (7919L*i) % N;
+        nerrors += (ba[k] != ref[k]);
+    }
+
+    return nerrors;
+}
+//
+// Round trips through compress(), compress(dm,ngrow) and uncompress(),
+// with BoxArrays sharing the compressed storage.  Returns the number of
+// errors.
+//
+static
+int
+CheckCompress (const BoxArray& ba0)
+{
+    int nerrors = 0;
+
+    Array<Box> ref(ba0.size());
+
+    for (int i = 0; i < ba0.size(); ++i)
+        ref[i] = ba0[i];
+
+    BoxArray ba(ba0.boxList()), shared(ba);
+
+    const long npts = ba.numPts();
+    const Box  mbox = ba.minimalBox();
+
+    ba.compress();
+
+    nerrors += !ba.isCompressed() || !shared.isCompressed() || !BoxArray::SameRefs(ba, shared);
+    nerrors += SameBoxes(ba, ref) + SameBoxes(shared, ref);
+    nerrors += (ba.numPts() != npts) || (ba.minimalBox() != mbox);
+    //
+    // Intersections work on the compressed boxes.
+    //
+    Array<Box> queries(ba.size());
+
+    for (int i = 0; i < ba.size(); ++i)
+        queries[i] = BoxLib::grow(ref[i], 1);
+
+    nerrors += CheckIntersections(ba, queries);
+    //
+    // Changing a copy leaves the compressed storage alone.
+    //
+    BoxArray changed(ba);
+    changed.refine(2);
+
+    nerrors += changed.isCompressed() || !ba.isCompressed() || BoxArray::SameRefs(ba, changed);
+    nerrors += SameBoxes(ba, ref);
+
+    for (int i = 0; i < changed.size(); ++i)
+        nerrors += (changed[i] != BoxLib::refine(ref[i], 2));
+
+    ba.uncompress();
+
+    nerrors += ba.isCompressed() || shared.isCompressed();
+    nerrors += SameBoxes(ba, ref) + SameBoxes(shared, ref);
+    //
+    // With the local boxes and their neighbors kept decoded, here every
+    // third box.
+    //
+    Array<int> pmap(ba.size()+1);
+
+    for (int i = 0; i < ba.size(); ++i)
+        pmap[i] = (i % 3 == 0) ? ParallelDescriptor::MyProc() : ParallelDescriptor::MyProc()+1;
+
+    pmap[ba.size()] = ParallelDescriptor::MyProc();
+
+    const DistributionMapping dm(pmap);
+
+    for (int ngrow = 0; ngrow <= 2; ++ngrow)
+    {
+        ba.compress(dm, ngrow);
+
+        nerrors += !ba.isCompressed() || !shared.isCompressed();
+        nerrors += SameBoxes(ba, ref) + SameBoxes(shared, ref);
+        nerrors += (ba.numPts() != npts);
+    }
+
+    ba.compress();
+    nerrors += SameBoxes(shared, ref);
+
+    shared.uncompress();
+    nerrors += ba.isCompressed() || SameBoxes(ba, ref);
+
+    return nerrors;
+}
+
+static
+int
+CheckCompressRoundTrips ()
+{
+    std::srand(54321);
+
+    BoxArray domain(Box(IntVect::TheZeroVector(), IntVect(D_DECL(63,63,63))));
+    domain.maxSize(8);
+
+    const int nerrors = CheckCompress(domain)
+                      + CheckCompress(RandomBoxArray(300, -100, 200, 20))
+                      + CheckCompress(RandomBoxArray(1, 0, 10, 5));
+
+    std::cout << "BoxArray compress round trips: " << nerrors << " errors" << std::endl;
+
+    return nerrors;
+}
+
 static
 void
 Print (const BoxList& bl, const char* str)
@@ -275,15 +811,19 @@ Print (const BoxList& bl, const char* str)
 }
 
 int
-main ()
+main (int argc, char* argv[])
 {
 //    std::ifstream ifs("ba.60", std::ios::in);
 //    std::ifstream ifs("ba.213", std::ios::in);
 //    std::ifstream ifs("ba.1000", std::ios::in);
 //    std::ifstream ifs("ba.5034", std::ios::in);
-    std::ifstream ifs("ba.15456", std::ios::in);
+//    std::ifstream ifs("ba.15456", std::ios::in);
 //    std::ifstream ifs("ba.mac.294", std::ios::in);
 //    std::ifstream ifs("ba.3865", std::ios::in);
+    if (CheckAgainstBruteForce() > 0 || CheckCompressRoundTrips() > 0)
+        return 1;
+
+    std::ifstream ifs(argc > 1 ? argv[1] : "ba.15456", std::ios::in);
 
     std::cout << "Got Here" << std::endl;
 
@@ -315,6 +855,8 @@ main ()
 
 //    exit(0);
 
+    SetOpsBenchmark(ba);
+
     bb.grow(4);
 
     BoxList bl;
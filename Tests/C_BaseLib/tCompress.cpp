@@ -0,0 +1,147 @@
+//
+// A test program for the BLCompress codec.
+//
+
+#include <cstring>
+#include <vector>
+#include <iostream>
+
+#include <BoxLib.H>
+#include <Utility.H>
+#include <BLCompress.H>
+
+static int nerrors(0);
+
+static void
+check (bool ok, const char* what)
+{
+    if (!ok) {
+        std::cout << "**** failed:  " << what << std::endl;
+        ++nerrors;
+    }
+}
+
+//
+// Compresses nvalues values of szvalue bytes, keeping keep bytes of each,
+// and returns the decompressed values and, in nbytes, the compressed size.
+//
+static std::vector<char>
+roundTrip (const void* src, long nvalues, int szvalue, int keep, long& nbytes)
+{
+    std::vector<char> msg(BLCompress::MaxCompressedSize(nvalues, keep));
+    nbytes = BLCompress::Compress(src, nvalues, szvalue, keep, msg.data());
+
+    std::vector<char> out(nvalues*szvalue + 1, 'x');
+    BLCompress::Decompress(msg.data(), nbytes, out.data(), nvalues, szvalue);
+
+    check(nbytes <= long(msg.size()), "within MaxCompressedSize");
+    check(out[nvalues*szvalue] == 'x', "no write past the values");
+    out.resize(nvalues*szvalue);
+    return out;
+}
+
+int
+main (int argc, char** argv)
+{
+    BoxLib::Initialize(argc, argv);
+
+    const long N = 100000;
+    const long stored = BLCompress::MaxCompressedSize(N, sizeof(double));
+    long nbytes;
+    //
+    // Constant data compress to almost nothing.
+    //
+    {
+        std::vector<double> v(N, 3.14159);
+        std::vector<char> out = roundTrip(v.data(), N, sizeof(double), sizeof(double), nbytes);
+        check(std::memcmp(out.data(), v.data(), N*sizeof(double)) == 0, "constant, lossless");
+        check(nbytes < stored / 100, "constant compresses");
+    }
+    //
+    // Smooth data compress somewhat.
+    //
+    {
+        std::vector<double> v(N);
+        for (long i = 0; i < N; ++i) v[i] = 1000.0 + i;
+        std::vector<char> out = roundTrip(v.data(), N, sizeof(double), sizeof(double), nbytes);
+        check(std::memcmp(out.data(), v.data(), N*sizeof(double)) == 0, "smooth, lossless");
+        check(nbytes < stored, "smooth compresses");
+    }
+    //
+    // Random bytes do not compress and are stored as they are.
+    //
+    {
+        BoxLib::mt19937 rr(4357UL);
+        std::vector<unsigned int> v(2*N);
+        for (long i = 0; i < 2*N; ++i) v[i] = rr.u_value();
+        std::vector<char> out = roundTrip(v.data(), N, sizeof(double), sizeof(double), nbytes);
+        check(std::memcmp(out.data(), v.data(), N*sizeof(double)) == 0, "random, lossless");
+        check(nbytes == stored, "random is stored");
+    }
+    //
+    // A lossless stream has a little-endian header and its planes in the
+    // order the bytes are stored, whatever the machine.
+    //
+    {
+        const long n = 1000;
+        BoxLib::mt19937 rr(99UL);
+        std::vector<unsigned int> v(2*n);
+        for (long i = 0; i < 2*n; ++i) v[i] = rr.u_value();
+        std::vector<char> msg(BLCompress::MaxCompressedSize(n, sizeof(double)));
+        nbytes = BLCompress::Compress(v.data(), n, sizeof(double), sizeof(double), msg.data());
+
+        const unsigned char* m = reinterpret_cast<const unsigned char*>(msg.data());
+        const unsigned char* b = reinterpret_cast<const unsigned char*>(v.data());
+        const int hdr = nbytes - n*sizeof(double);
+        bool ok = hdr == 10 && m[1] == sizeof(double)
+            && m[2] == (n & 0xff) && m[3] == (n >> 8) && m[4] == 0 && m[9] == 0;
+        for (int p = 0; ok && p < int(sizeof(double)); ++p)
+            for (long i = 0; i < n; ++i)
+                if (m[hdr + p*n + i] != b[i*sizeof(double) + p]) ok = false;
+        check(ok, "portable layout");
+    }
+    //
+    // Empty input.
+    //
+    {
+        std::vector<char> out = roundTrip(0, 0, sizeof(double), sizeof(double), nbytes);
+        check(out.empty() && nbytes == BLCompress::MaxCompressedSize(0, sizeof(double)),
+              "empty");
+    }
+    //
+    // With keep < szvalue the least significant bytes are zero.
+    //
+    {
+        BoxLib::mt19937 rr(1234UL);
+        std::vector<double> v(N);
+        for (long i = 0; i < N; ++i) v[i] = rr.d_value() * 1.e6;
+        std::vector<char> out = roundTrip(v.data(), N, sizeof(double), 4, nbytes);
+        check(nbytes <= BLCompress::MaxCompressedSize(N, 4), "truncated size");
+
+        bool ok = true;
+        for (long i = 0; i < N; ++i) {
+            unsigned long long a, b;
+            std::memcpy(&a, &v[i], sizeof(a));
+            std::memcpy(&b, out.data() + i*sizeof(double), sizeof(b));
+            if (b != (a & 0xFFFFFFFF00000000ULL)) ok = false;
+        }
+        check(ok, "double truncated to 4 bytes");
+
+        std::vector<unsigned int> w(N);
+        for (long i = 0; i < N; ++i) w[i] = rr.u_value();
+        out = roundTrip(w.data(), N, sizeof(unsigned int), 1, nbytes);
+        ok = true;
+        for (long i = 0; i < N; ++i) {
+            unsigned int b;
+            std::memcpy(&b, out.data() + i*sizeof(b), sizeof(b));
+            if (b != (w[i] & 0xFF000000u)) ok = false;
+        }
+        check(ok, "int truncated to 1 byte");
+    }
+
+    std::cout << "tCompress:  " << nerrors << " errors" << std::endl;
+
+    BoxLib::Finalize();
+
+    return nerrors > 0;
+}
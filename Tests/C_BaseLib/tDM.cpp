@@ -1,3 +1,4 @@
+#include <cmath>
 #include <iostream>
 #include <fstream>
 #include <BoxArray.H>
@@ -17,11 +18,108 @@ Print (const BoxList& bl, const char* str)
     }
 }
 
+//
+// Rebalance() a map where process 0 carries boxes three times as costly
+// as the others.  It must get within the threshold by moving the fewest
+// boxes, all from process 0, and leave a balanced map alone.
+//
+static
+bool
+TestRebalance ()
+{
+    const int  nprocs    = ParallelDescriptor::NProcs();
+    const int  N         = 8*nprocs;
+    const Real threshold = 1.2;
+
+    Array<int>  pmap(N+1);
+    Array<Real> cost(N);
+    for (int i = 0; i < N; ++i) {
+        pmap[i] = i % nprocs;
+        cost[i] = (pmap[i] == 0) ? 3 : 1;
+    }
+    pmap[N] = ParallelDescriptor::MyProc();
+
+    DistributionMapping current(pmap);
+    Array<int>          newmap;
+
+    const bool moved = DistributionMapping::Rebalance(cost, current, threshold, newmap);
+
+    std::vector<Real> load(nprocs, 0.0);
+    int nmoved = 0;
+    bool ok = (newmap.size() == N+1 && newmap[N] == pmap[N]);
+    for (int i = 0; i < N; ++i) {
+        load[newmap[i]] += cost[i];
+        if (newmap[i] != pmap[i]) {
+            ++nmoved;
+            if (pmap[i] != 0) ok = false;
+        }
+    }
+
+    const Real avg  = (24.0 + 8.0*(nprocs-1)) / nprocs;
+    const int  need = (nprocs > 1) ? int(std::ceil((24.0 - threshold*avg) / 3)) : 0;
+    const Real imbalance = *std::max_element(load.begin(), load.end()) / avg;
+
+    ok = ok && nmoved == need && moved == (need > 0) && imbalance <= threshold;
+    //
+    // Nothing to do under equal costs.
+    //
+    Array<Real> flat(N, 1.0);
+    ok = ok && !DistributionMapping::Rebalance(flat, current, threshold, newmap)
+            && newmap == pmap;
+
+    if (ParallelDescriptor::IOProcessor())
+        std::cout << "Rebalance:  moved " << nmoved << " of " << N << " boxes, imbalance "
+                  << imbalance << (ok ? "" : "  FAILED") << '\n';
+
+    return ok;
+}
+
+//
+// The node map is set up by Initialize(), so it can be looked up on the
+// I/O processor alone.
+//
+static
+bool
+TestNodeMap ()
+{
+    bool ok = true;
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        const int nnodes = DistributionMapping::NNodes();
+
+        int nranks = 0;
+        for (int node = 0; node < nnodes; ++node)
+        {
+            const Array<int>& ranks = DistributionMapping::RanksOnNode(node);
+            nranks += ranks.size();
+            for (int i = 0; i < ranks.size(); ++i)
+                if (DistributionMapping::NodeOfRank(ranks[i]) != node) ok = false;
+        }
+
+        ok = ok && nnodes >= 1 && nranks == ParallelDescriptor::NProcs()
+                && DistributionMapping::NodeOfRank(0) == 0;
+
+        std::cout << "Node map:  " << nranks << " processes on " << nnodes << " nodes"
+                  << (ok ? "" : "  FAILED") << '\n';
+    }
+
+    ParallelDescriptor::ReduceBoolAnd(ok);
+
+    return ok;
+}
+
 int
 main (int argc, char* argv[])
 {
     BoxLib::Initialize(argc, argv);
 
+    if (!TestNodeMap())
+        BoxLib::Abort("tDM: the node map is wrong");
+
+    if (!TestRebalance())
+        BoxLib::Abort("tDM: Rebalance() failed");
+
 //    std::ifstream ifs("ba.60", std::ios::in);
 //    std::ifstream ifs("ba.213", std::ios::in);
 //    std::ifstream ifs("ba.1000", std::ios::in);
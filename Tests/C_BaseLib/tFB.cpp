@@ -2,12 +2,181 @@
 // A test program for FillBoundary().
 //
 
+#include <cstring>
+
 #include <Utility.H>
 #include <MultiFab.H>
 
 const int nTimes(5);
 const int nStrategies(4);
 
+static Real
+value (const IntVect& iv, int n)
+{
+    //
+    // Not exact in fewer than 8 bytes, so compressed messages show.
+    //
+    return D_TERM(iv[0], + 100*iv[1], + 10000*iv[2]) + 1.e6*n + 0.123456789;
+}
+
+//
+// Sets the valid cells to value() and the ghost cells to garbage.
+//
+static void
+setValid (MultiFab& mf)
+{
+    mf.setVal(-1.e200);
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        const Box& bx = mfi.validbox();
+        for (int n = 0; n < mf.nComp(); ++n)
+            for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+                mf[mfi](iv,n) = value(iv,n);
+    }
+}
+
+//
+// MFOverlapIter over a FillBoundary_nowait():  each tile is visited
+// once, and the ghost cells of its footprint have been filled by then.
+//
+static int
+testOverlapIter (bool useCosts)
+{
+    Box domain(IntVect(D_DECL(0,0,0)), IntVect(D_DECL(63,63,63)));
+    BoxArray ba(domain);
+    ba.maxSize(16);
+
+    const int ng = 2;
+    MultiFab mf(ba, 2, ng);
+    FabCosts costs(mf);
+
+    std::vector< std::pair<int,Box> > tiles;
+    for (MFIter mfi(mf,true); mfi.isValid(); ++mfi)
+        tiles.push_back(std::make_pair(mfi.index(), mfi.tilebox()));
+
+    std::vector<int> nvisits(tiles.size(), 0);
+    int nerrors = 0, nboundary = 0;
+
+    setValid(mf);
+
+    mf.FillBoundary_nowait();
+
+#ifdef _OPENMP
+#pragma omp parallel reduction(+:nerrors,nboundary)
+#endif
+    {
+        MFOverlapIter<FArrayBox>* mfi = useCosts
+            ? new MFOverlapIter<FArrayBox>(mf, costs, true)
+            : new MFOverlapIter<FArrayBox>(mf, true);
+
+        for ( ; mfi->isValid(); ++(*mfi))
+        {
+            const Box& tbx = mfi->tilebox();
+            for (int t = 0, N = tiles.size(); t < N; ++t) {
+                if (tiles[t].first == mfi->index() && tiles[t].second == tbx) {
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+                    ++nvisits[t];
+                }
+            }
+            if (mfi->boundaryTile()) ++nboundary;
+
+            const Box bx = mfi->growntilebox(ng) & domain;
+            const FArrayBox& fab = mf[*mfi];
+            for (int n = 0; n < mf.nComp(); ++n)
+                for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+                    if (fab(iv,n) != value(iv,n)) ++nerrors;
+        }
+
+        delete mfi;
+    }
+
+    mf.FillBoundary_finish();
+
+    for (int t = 0, N = tiles.size(); t < N; ++t)
+        if (nvisits[t] != 1) ++nerrors;
+
+    ParallelDescriptor::ReduceIntSum(nerrors);
+    ParallelDescriptor::ReduceIntSum(nboundary);
+
+    if (ParallelDescriptor::IOProcessor())
+        std::cout << "MFOverlapIter" << (useCosts ? " with costs" : "") << ":  "
+                  << nboundary << " boundary tiles, " << nerrors << " errors" << std::endl;
+
+    return nerrors;
+}
+
+
+//
+// The batched FillBoundary() of several MultiFabs, with different
+// component ranges, must give the same ghost cells as one at a time.
+// The last one compresses its messages, which are then sent on their own.
+//
+static int
+testBatchedFillBoundary ()
+{
+    Box domain(IntVect(D_DECL(0,0,0)), IntVect(D_DECL(47,47,47)));
+    BoxArray ba(domain);
+    ba.maxSize(16);
+
+    const int ng = 2;
+    const int nmfs = 4;
+    const int nc[nmfs] = {3, 2, 4, 2};
+
+    Array<int> scomp(nmfs), ncomp(nmfs);
+    scomp[0] = 0; ncomp[0] = 3;
+    scomp[1] = 1; ncomp[1] = 1;
+    scomp[2] = 1; ncomp[2] = 2;
+    scomp[3] = 0; ncomp[3] = 2;
+
+    int nerrors = 0;
+
+    for (int p = 0; p < 2; ++p) {
+      for (int c = 0; c < 2; ++c) {
+        const Periodicity period = (p == 0) ? Periodicity::NonPeriodic()
+                                            : Periodicity(domain.size());
+        const bool cross = (c == 1);
+
+        PArray<MultiFab> batched(nmfs, PArrayManage), separate(nmfs, PArrayManage);
+        Array<FabArray<FArrayBox>*> mfs(nmfs);
+
+        for (int i = 0; i < nmfs; ++i) {
+            batched.set(i, new MultiFab(ba, nc[i], ng));
+            separate.set(i, new MultiFab(ba, nc[i], ng));
+            if (i == nmfs-1) {
+                batched[i].setCommCompression(FabArrayBase::TRUNCATE, 4);
+                separate[i].setCommCompression(FabArrayBase::TRUNCATE, 4);
+            }
+            setValid(batched[i]);
+            setValid(separate[i]);
+            mfs[i] = &batched[i];
+        }
+
+        FabArray<FArrayBox>::FillBoundary(mfs, scomp, ncomp, period, cross);
+
+        for (int i = 0; i < nmfs; ++i) {
+            separate[i].FillBoundary(scomp[i], ncomp[i], period, cross);
+        }
+
+        for (int i = 0; i < nmfs; ++i) {
+            for (MFIter mfi(batched[i]); mfi.isValid(); ++mfi) {
+                const FArrayBox& a = batched[i][mfi];
+                const FArrayBox& b = separate[i][mfi];
+                if (std::memcmp(a.dataPtr(), b.dataPtr(), a.nBytes()) != 0) {
+                    ++nerrors;
+                }
+            }
+        }
+      }
+    }
+
+    ParallelDescriptor::ReduceIntSum(nerrors);
+
+    if (ParallelDescriptor::IOProcessor())
+        std::cout << "Batched FillBoundary:  " << nerrors << " errors" << std::endl;
+
+    return nerrors;
+}
 
 int
 main (int argc, char** argv)
@@ -16,6 +185,12 @@ main (int argc, char** argv)
 
   BL_PROFILE_VAR("main()", pmain);
 
+  if (testOverlapIter(false) + testOverlapIter(true) > 0)
+      BoxLib::Abort("tFB: MFOverlapIter failed");
+
+  if (testBatchedFillBoundary() > 0)
+      BoxLib::Abort("tFB: batched FillBoundary failed");
+
   Array<DistributionMapping::Strategy> dmStrategies(nStrategies);
   dmStrategies[0] = DistributionMapping::ROUNDROBIN;
   dmStrategies[1] = DistributionMapping::KNAPSACK;
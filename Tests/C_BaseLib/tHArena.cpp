@@ -0,0 +1,169 @@
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <REAL.H>
+#include <BArena.H>
+#include <HArena.H>
+#include <Utility.H>
+
+//
+// Compares BArena and HArena on two access patterns that miss in the TLB
+// with 4 KB pages: a 7-point stencil on an n^3 array, whose k-1 and k+1
+// neighbors are n^2 values away, and a gather from random locations.
+//
+// Usage: tHArena [n [ncomp]]
+//
+
+namespace
+{
+    double
+    stencil (Arena& arena, int n, int ncomp, int nsteps)
+    {
+        const long npts = long(n)*n*n;
+        const long nxy  = long(n)*n;
+
+        double* a = static_cast<double*>(arena.alloc(npts*ncomp*sizeof(double)));
+        double* b = static_cast<double*>(arena.alloc(npts*ncomp*sizeof(double)));
+
+        for (long i = 0; i < npts*ncomp; ++i)
+        {
+            a[i] = double(i%17);
+            b[i] = 0;
+        }
+
+        const double t0 = BoxLib::wsecond();
+
+        for (int step = 0; step < nsteps; ++step)
+        {
+            for (int c = 0; c < ncomp; ++c)
+            {
+                const double* ac = a + c*npts;
+                double*       bc = b + c*npts;
+                //
+                // Sweep pencils of 8 values along k, so that every cache
+                // line is used but nearly every access is on a new page.
+                //
+                for (int j = 1; j < n-1; ++j)
+                    for (int i0 = 1; i0 < n-1; i0 += 8)
+                        for (int k = 1; k < n-1; ++k)
+                            for (int i = i0; i < std::min(i0+8,n-1); ++i)
+                            {
+                                const long p = i + long(j)*n + long(k)*nxy;
+                                bc[p] = ac[p] - (1.0/6.0)*(ac[p-1] + ac[p+1] + ac[p-n] + ac[p+n]
+                                                           + ac[p-nxy] + ac[p+nxy]);
+                            }
+            }
+            std::swap(a,b);
+        }
+
+        const double t = BoxLib::wsecond() - t0;
+
+        double sum = 0;
+        for (long i = 0; i < npts*ncomp; i += 4099) sum += a[i];
+        std::cout << "      (checksum " << sum << ")\n";
+
+        arena.free(a);
+        arena.free(b);
+
+        return t;
+    }
+
+    double
+    gather (Arena& arena, long nvalues, long nreads)
+    {
+        double* a = static_cast<double*>(arena.alloc(nvalues*sizeof(double)));
+
+        for (long i = 0; i < nvalues; ++i) a[i] = 1.0;
+
+        //
+        // Each read is near one of the random locations, which are on
+        // blocks of mask+1 values, so that it stays below nvalues.
+        //
+        const long mask = nvalues >= 512 ? 511 : 0;
+
+        std::vector<long> idx(1<<16);
+        for (int i = 0; i < idx.size(); ++i)
+            idx[i] = long(BoxLib::Random()*(nvalues/(mask+1))) * (mask+1);
+
+        const double t0 = BoxLib::wsecond();
+
+        double sum = 0;
+        for (long r = 0; r < nreads; ++r)
+            sum += a[idx[r & (idx.size()-1)] ^ (r & mask)];
+
+        const double t = BoxLib::wsecond() - t0;
+
+        std::cout << "      (checksum " << sum << ")\n";
+
+        arena.free(a);
+
+        return t;
+    }
+
+    //
+    // Are blocks of all sizes, from the heap and mapped, with each of the
+    // cache line offsets, aligned to HArena::Alignment?
+    //
+    bool
+    aligned ()
+    {
+        HArena arena(8192);
+
+        bool ok = true;
+
+        std::vector<void*> blocks;
+        for (std::size_t nbytes = 1; nbytes < (1<<20); nbytes = 3*nbytes + 1)
+            blocks.push_back(arena.alloc(nbytes));
+        for (int i = 0; i < 40; ++i)
+            blocks.push_back(arena.alloc(8192 + 8*i));
+
+        for (int i = 0; i < blocks.size(); ++i)
+        {
+            if (reinterpret_cast<std::size_t>(blocks[i]) % HArena::Alignment != 0)
+                ok = false;
+            arena.free(blocks[i]);
+        }
+
+        return ok && arena.heap_space_used() == 0;
+    }
+}
+
+int
+main (int argc, char* argv[])
+{
+    const int n     = argc > 1 ? std::atoi(argv[1]) : 256;
+    const int ncomp = argc > 2 ? std::atoi(argv[2]) : 2;
+
+    if (!aligned())
+    {
+        std::cout << "HArena returned a misaligned block\n";
+        return 1;
+    }
+
+    BArena barena;
+    HArena harena;
+
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        const double tb = stencil(barena, n, ncomp, 3);
+        const double th = stencil(harena, n, ncomp, 3);
+        std::cout << "stencil " << n << "^3 x " << ncomp << ": BArena " << tb
+                  << " s, HArena " << th << " s\n";
+    }
+
+    const long nvalues = long(n)*n*n*ncomp;
+    const long nreads  = 1L << 26;
+
+    const double gb = gather(barena, nvalues, nreads);
+    const double gh = gather(harena, nvalues, nreads);
+    std::cout << "gather from " << nvalues*sizeof(double)/(1024*1024) << " MB: BArena "
+              << gb << " s, HArena " << gh << " s\n";
+
+    std::cout << "HArena huge page space in use at the end: "
+              << harena.huge_space_used() << " bytes\n";
+
+    return 0;
+}
@@ -0,0 +1,104 @@
+//
+// A test program for the deferred reductions of Lazy.H: the _nowait
+// reductions of MultiFab must give what the blocking ones give.
+//
+
+#include <iostream>
+
+#include <BoxLib.H>
+#include <MultiFab.H>
+#include <Lazy.H>
+
+static int nerrors(0);
+
+static void
+check (Real deferred, Real blocking, const char* what)
+{
+    if (deferred != blocking) {
+        if (ParallelDescriptor::IOProcessor())
+            std::cout << "**** failed:  " << what << ":  " << deferred
+                      << " != " << blocking << std::endl;
+        ++nerrors;
+    }
+}
+
+int
+main (int argc, char** argv)
+{
+    BoxLib::Initialize(argc, argv);
+
+    BoxArray ba(Box(IntVect::TheZeroVector(),IntVect(D_DECL(63,63,63))));
+    ba.maxSize(16);
+    //
+    // Small integers and halves, so that sums in any order are exact.
+    //
+    MultiFab x(ba,2,1), y(ba,1,1);
+
+    for (MFIter mfi(x); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = x[mfi].box();
+
+        for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+        {
+            const int h = D_TERM(iv[0], + 3*iv[1], + 7*iv[2]) + 5*mfi.index();
+            x[mfi](iv,0) = (h % 17) - 8.5;
+            x[mfi](iv,1) = (h % 5) + 0.5;
+            y[mfi](iv,0) = (h % 3) - 1.0;
+        }
+    }
+    //
+    // One at a time, each posted by the first access.
+    //
+    for (int n = 0; n < x.nComp(); ++n)
+    {
+        check(x.min_nowait(n),    x.min(n),         "min");
+        check(x.min_nowait(n,1),  x.min(n,1),       "min with ghost cells");
+        check(x.max_nowait(n),    x.max(n),         "max");
+        check(x.max_nowait(n,1),  x.max(n,1),       "max with ghost cells");
+        check(x.norm0_nowait(n),  x.norm0(n),       "norm0");
+        check(x.norm1_nowait(n),  x.norm1(n),       "norm1");
+        check(x.norm1_nowait(n,1),x.norm1(n,1),     "norm1 with ghost cells");
+        check(x.norm2_nowait(n),  x.norm2(n),       "norm2");
+        check(x.sum_nowait(n),    x.sum(n),         "sum");
+        check(MultiFab::Dot_nowait(x,n,y,0,1,1), MultiFab::Dot(x,n,y,0,1,1), "Dot");
+    }
+    //
+    // Many at once, in a single allreduce posted by StartReductions().
+    // Once posted, the values may be read on the I/O processor only.
+    //
+    {
+        Lazy::DeferredReal r[] = {
+            x.min_nowait(0), x.max_nowait(1,1), x.norm0_nowait(0), x.norm1_nowait(1),
+            x.norm2_nowait(0), x.sum_nowait(1), MultiFab::Dot_nowait(x,0,y,0,1,0)
+        };
+        const Real b[] = {
+            x.min(0), x.max(1,1), x.norm0(0), x.norm1(1),
+            x.norm2(0), x.sum(1), MultiFab::Dot(x,0,y,0,1,0)
+        };
+        const int N = sizeof(b)/sizeof(b[0]);
+
+        Lazy::StartReductions();
+
+        if (ParallelDescriptor::IOProcessor())
+        {
+            r[N-1].get();
+            for (int i = 0; i < N; ++i)
+            {
+                if (!r[i].ready()) {
+                    std::cout << "**** failed:  batch " << i << " not ready" << std::endl;
+                    ++nerrors;
+                }
+                check(r[i], b[i], "batched");
+            }
+        }
+    }
+
+    ParallelDescriptor::ReduceIntMax(nerrors);
+
+    if (ParallelDescriptor::IOProcessor())
+        std::cout << "tLazy:  " << nerrors << " errors" << std::endl;
+
+    BoxLib::Finalize();
+
+    return nerrors > 0;
+}
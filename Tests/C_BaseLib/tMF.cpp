@@ -9,6 +9,37 @@
 #include <Utility.H>
 #include <MultiFab.H>
 
+//
+// Does alias share the data of components 1 and 2 of mf, set to aval, and
+// the BoxArray and distribution of mf?  The others are 1.
+//
+static bool
+CheckAlias (const MultiFab& mf, const MultiFab& alias, Real aval)
+{
+    bool ok = alias.isAlias()
+        && alias.nComp() == 2
+        && alias.nGrow() == mf.nGrow()
+        && alias.IndexArray() == mf.IndexArray()
+        && BoxArray::SameRefs(alias.boxArray(),mf.boxArray())
+        && alias.DistributionMap().getRefID() == mf.DistributionMap().getRefID()
+        && alias.color() == mf.color()
+        && mf.ok() && alias.ok();
+
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+    {
+        if (alias[mfi].dataPtr() != mf[mfi].dataPtr(1)) ok = false;
+        for (int n = 0; n < mf.nComp(); ++n)
+        {
+            const Real v = (n == 1 || n == 2) ? aval : 1.0;
+            if (mf[mfi].min(n) != v || mf[mfi].max(n) != v) ok = false;
+        }
+    }
+
+    ParallelDescriptor::ReduceBoolAnd(ok);
+
+    return ok;
+}
+
 int
 main (int argc, char** argv)
 {
@@ -203,6 +234,42 @@ main (int argc, char** argv)
         std::cout << "Got " << bins.size() << " (key,val) pairs:\n";
     }
 #endif
+    //
+    // An alias shares the data, BoxArray and distribution of its source,
+    // also after MoveAllFabs() has moved the FABs of both.
+    //
+    {
+        BoxArray ba(Box(IntVect::TheZeroVector(),IntVect(D_DECL(63,63,63))));
+        ba.maxSize(16);
+
+        MultiFab mf(ba,4,1);
+        mf.setVal(1.0);
+
+        MultiFab alias;
+        alias.defineAlias(mf,1,2);
+        alias.setVal(2.0);
+
+        bool ok = CheckAlias(mf, alias, 2.0);
+
+        Array<int> pmap = mf.DistributionMap().ProcessorMap();
+        for (int i = 0; i < pmap.size()-1; ++i)
+            pmap[i] = (pmap[i] + 1) % NProcs;
+        pmap[pmap.size()-1] = MyProc;
+
+        MultiFab::MoveAllFabs(pmap);
+
+        ok = CheckAlias(mf, alias, 2.0) && ok;
+
+        alias.setVal(3.0);
+
+        ok = CheckAlias(mf, alias, 3.0) && ok;
+
+        if (ParallelDescriptor::IOProcessor())
+            std::cout << "defineAlias: " << (ok ? "ok" : "FAILED") << '\n';
+
+        if (!ok)
+            BoxLib::Abort("tMF: alias does not share its source");
+    }
 
     BoxLib::Finalize();
 
@@ -2,10 +2,16 @@
 // email push test 0
 // ----------------------------------
 
+#include <algorithm>
 #include <cstdlib>
+#include <cmath>
+#include <fstream>
+#include <iterator>
 #include <string>
 
+#include <MultiFab.H>
 #include <VisMF.H>
+#include <NFiles.H>
 #include <Utility.H>
 
 static int nBoxs  = 10;
@@ -75,6 +81,8 @@ Write_N_Read (const MultiFab& mf,
         start = BoxLib::wsecond();
     }
 
+    VisMF::Write(mf, mf_name);
+
     ParallelDescriptor::Barrier();
 
     if (ParallelDescriptor::IOProcessor())
@@ -114,6 +122,362 @@ Write_N_Read (const MultiFab& mf,
     VisMF::Read(new_mf, mf_name);
 }
 
+//
+// The largest relative error of a against b over the valid and ghost cells
+// of comp of b, or the absolute error where b is zero.
+//
+static
+Real
+RelErr (const FArrayBox& a,
+        int              acomp,
+        const FArrayBox& b,
+        int              comp)
+{
+    Real err = 0;
+
+    const Box& bx = b.box();
+
+    for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+    {
+        const Real d = std::abs(a(iv,acomp) - b(iv,comp));
+        err = std::max(err, b(iv,comp) == 0 ? d : d / std::abs(b(iv,comp)));
+    }
+
+    return err;
+}
+
+//
+// Write mf as NoFabHeaderCompressed_v1 with tolerance tol, read it back
+// with and without aggregated reads and a component at a time, and
+// return the largest relative error.
+//
+static
+Real
+Write_N_Read_Compressed (const MultiFab&    mf,
+                         const std::string& mf_name,
+                         Real               tol)
+{
+    VisMF::Header::Version oldVersion = VisMF::GetHeaderVersion();
+
+    VisMF::SetHeaderVersion(VisMF::Header::NoFabHeaderCompressed_v1);
+    VisMF::SetCompressTolerance(tol);
+
+    VisMF::Write(mf, mf_name);
+
+    Real err = 0;
+
+    for (int agg = 0; agg < 2; ++agg)
+    {
+        VisMF::SetUseAggregatedReads(agg);
+
+        MultiFab new_mf;
+
+        VisMF::Read(new_mf, mf_name);
+
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+            for (int n = 0; n < mf.nComp(); ++n)
+                err = std::max(err, RelErr(new_mf[mfi], n, mf[mfi], n));
+    }
+
+    VisMF::SetUseAggregatedReads(false);
+    //
+    // GetFab() reads a single component, skipping those before it.
+    //
+    VisMF vmf(mf_name);
+
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+    {
+        for (int n = mf.nComp()-1; n >= 0; --n)
+        {
+            const FArrayBox& fab = vmf.GetFab(mfi.index(), n);
+
+            BL_ASSERT(fab.box() == mf[mfi].box() && fab.nComp() == 1);
+
+            err = std::max(err, RelErr(fab, 0, mf[mfi], n));
+        }
+    }
+
+    ParallelDescriptor::ReduceRealMax(err);
+
+    VisMF::SetCompressTolerance(0);
+    VisMF::SetHeaderVersion(oldVersion);
+
+    return err;
+}
+
+//
+// Write mf with histograms and check, against a scan of the values read
+// back, that mayContain() never rules out a FAB holding a value in the
+// queried range.  Returns the number of wrongly pruned queries.
+//
+static
+int
+Check_MayContain (const MultiFab&        mf,
+                  const std::string&     mf_name,
+                  VisMF::Header::Version version,
+                  Real                   tol)
+{
+    VisMF::Header::Version oldVersion = VisMF::GetHeaderVersion();
+
+    VisMF::SetHeaderVersion(version);
+    VisMF::SetCompressTolerance(tol);
+    VisMF::SetNHistogramBins(16);
+
+    VisMF::Write(mf, mf_name);
+
+    MultiFab new_mf;
+
+    VisMF::Read(new_mf, mf_name);
+
+    VisMF vmf(mf_name);
+
+    const int nRanges = 64;
+
+    int nerrors = 0, npruned = 0;
+
+    for (int n = 0; n < new_mf.nComp(); ++n)
+    {
+        const Real lo = new_mf.min(n), hi = new_mf.max(n);
+        const Real dx = (hi - lo) / nRanges;
+
+        for (MFIter mfi(new_mf); mfi.isValid(); ++mfi)
+        {
+            const FArrayBox& fab = new_mf[mfi];
+            const Box&       bx  = mfi.validbox();
+            //
+            // Each value on its own, and equal ranges spanning all values.
+            //
+            long cnt = 0;
+
+            for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv), ++cnt)
+            {
+                if (cnt % 5 == 0 && !vmf.mayContain(mfi.index(), n, fab(iv,n), fab(iv,n)))
+                    ++nerrors;
+            }
+
+            for (int r = 0; r < nRanges; ++r)
+            {
+                const Real qlo = lo + r*dx, qhi = (r == nRanges-1) ? hi : lo + (r+1)*dx;
+
+                bool hit = false;
+
+                for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd() && !hit; bx.next(iv))
+                    hit = (fab(iv,n) >= qlo && fab(iv,n) <= qhi);
+
+                if (!vmf.mayContain(mfi.index(), n, qlo, qhi))
+                {
+                    ++npruned;
+                    if (hit) ++nerrors;
+                }
+            }
+        }
+    }
+
+    ParallelDescriptor::ReduceIntSum(nerrors);
+    ParallelDescriptor::ReduceIntSum(npruned);
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        std::cout << "mayContain:  version " << version << ", tolerance " << tol
+                  << ", format " << FArrayBox::getFormat() << ":  "
+                  << npruned << " ranges pruned, " << nerrors << " errors\n";
+    }
+
+    VisMF::SetNHistogramBins(0);
+    VisMF::SetCompressTolerance(0);
+    VisMF::SetHeaderVersion(oldVersion);
+
+    return nerrors;
+}
+
+//
+// Write a copy of mf with AsyncWrite(), change the copy right away, and
+// check that what is read back after WaitForAsyncWrites() is what Write()
+// writes of mf, ghost cells included.  Returns the number of errors.
+//
+static
+int
+Check_AsyncWrite (const MultiFab&        mf,
+                  const std::string&     mf_name,
+                  VisMF::Header::Version version)
+{
+    VisMF::Header::Version oldVersion = VisMF::GetHeaderVersion();
+
+    VisMF::SetHeaderVersion(version);
+
+    const std::string sync_name = mf_name + "-Sync";
+
+    {
+        MultiFab amf(mf.boxArray(), mf.nComp(), mf.nGrow(), mf.DistributionMap());
+
+        MultiFab::Copy(amf, mf, 0, 0, mf.nComp(), mf.nGrow());
+
+        VisMF::AsyncWrite(amf, mf_name);
+
+        amf.setVal(-5);
+    }
+
+    VisMF::Write(mf, sync_name);
+
+    VisMF::WaitForAsyncWrites();
+
+    MultiFab amf, smf;
+
+    VisMF::Read(amf, mf_name);
+    VisMF::Read(smf, sync_name);
+
+    int nerrors = 0;
+
+    if (amf.boxArray() != smf.boxArray() || amf.nComp() != smf.nComp() || amf.nGrow() != smf.nGrow())
+    {
+        ++nerrors;
+    }
+    else
+    {
+        MultiFab::Subtract(amf, smf, 0, 0, amf.nComp(), amf.nGrow());
+
+        for (int n = 0; n < amf.nComp(); ++n)
+            if (amf.norm0(n, amf.nGrow()) != 0)
+                ++nerrors;
+    }
+
+    //
+    // The same data files, byte for byte.
+    //
+    int nfiles_differ = 0;
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        const int nFiles = NFilesIter::ActualNFiles(VisMF::GetNOutFiles());
+
+        for (int i = 0; i < nFiles; ++i)
+        {
+            const std::string aname = NFilesIter::FileName(i, mf_name + "_D_");
+            const std::string sname = NFilesIter::FileName(i, sync_name + "_D_");
+            std::ifstream afs(aname.c_str(), std::ios::binary), sfs(sname.c_str(), std::ios::binary);
+
+            if (std::string(std::istreambuf_iterator<char>(afs), std::istreambuf_iterator<char>()) !=
+                std::string(std::istreambuf_iterator<char>(sfs), std::istreambuf_iterator<char>()))
+                ++nfiles_differ;
+        }
+    }
+
+    ParallelDescriptor::ReduceIntSum(nfiles_differ);
+
+    nerrors += nfiles_differ;
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        std::cout << "AsyncWrite:  version " << version
+                  << ", format " << FArrayBox::getFormat()
+                  << ", nOutFiles " << VisMF::GetNOutFiles() << ":  "
+                  << nerrors << " errors\n";
+    }
+
+    VisMF::CloseAllStreams();  // ---- the files are rewritten
+    VisMF::RemoveFiles(sync_name);
+    VisMF::SetHeaderVersion(oldVersion);
+
+    ParallelDescriptor::Barrier();
+
+    return nerrors;
+}
+
+//
+// Write mf and check that mapFAB() of each FAB, whole and by component,
+// holds what readFAB() reads, for the versions and formats it maps, and
+// returns 0 for the others.  Returns the number of errors.
+//
+static
+int
+Check_MapFAB (const MultiFab&        mf,
+              const std::string&     mf_name,
+              VisMF::Header::Version version)
+{
+    VisMF::Header::Version oldVersion = VisMF::GetHeaderVersion();
+
+    VisMF::SetHeaderVersion(version);
+
+    VisMF::Write(mf, mf_name);
+
+    const bool mappable = FArrayBox::getFormat() == FABio::FAB_NATIVE &&
+                          (version == VisMF::Header::NoFabHeader_v1       ||
+                           version == VisMF::Header::NoFabHeaderMinMax_v1 ||
+                           version == VisMF::Header::NoFabHeaderFAMinMax_v1);
+
+    VisMF vmf(mf_name);
+
+    int nerrors = 0, nmapped = 0;
+
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+    {
+        for (int comp = -1; comp < mf.nComp(); ++comp)
+        {
+            FArrayBox* mapped = vmf.mapFAB(mfi.index(), comp);
+            FArrayBox* read   = (comp == -1) ? vmf.readFAB(mfi.index(), mf_name)
+                                             : vmf.readFAB(mfi.index(), comp);
+            if (mapped == 0)
+            {
+                if (mappable) ++nerrors;
+                delete read;
+                continue;
+            }
+
+            ++nmapped;
+
+            if (!mappable || mapped->box() != read->box() || mapped->nComp() != read->nComp())
+            {
+                ++nerrors;
+            }
+            else
+            {
+                const long N = read->box().numPts() * read->nComp();
+
+                if (!std::equal(read->dataPtr(), read->dataPtr() + N, mapped->dataPtr()))
+                    ++nerrors;
+            }
+
+            delete mapped;
+            delete read;
+        }
+        //
+        // Writes to a mapped FAB never reach the file.
+        //
+        if (FArrayBox* mapped = vmf.mapFAB(mfi.index(), -1))
+        {
+            FArrayBox* read = vmf.readFAB(mfi.index(), mf_name);
+
+            mapped->setVal(-1);
+
+            FArrayBox* reread = vmf.readFAB(mfi.index(), mf_name);
+
+            const long N = read->box().numPts() * read->nComp();
+
+            if (!std::equal(read->dataPtr(), read->dataPtr() + N, reread->dataPtr()))
+                ++nerrors;
+
+            delete reread;
+            delete read;
+            delete mapped;
+        }
+    }
+
+    ParallelDescriptor::ReduceIntSum(nerrors);
+    ParallelDescriptor::ReduceIntSum(nmapped);
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        std::cout << "mapFAB:  version " << version
+                  << ", format " << FArrayBox::getFormat() << ":  "
+                  << nmapped << " FABs mapped, " << nerrors << " errors\n";
+    }
+
+    VisMF::CloseAllStreams();  // ---- the file is rewritten
+    VisMF::SetHeaderVersion(oldVersion);
+
+    return nerrors;
+}
+
 int
 main (int argc, char** argv)
 {
@@ -145,6 +509,120 @@ main (int argc, char** argv)
 
     Write_N_Read (mf,
                   mf_name);
+    //
+    // Compressed, losslessly and within a tolerance.  Smooth data with some
+    // zeros, negative values and a constant component.
+    //
+    MultiFab smf(ba, 3, 1);
+
+    for (MFIter mfi(smf); mfi.isValid(); ++mfi)
+    {
+        FArrayBox& fab = smf[mfi];
+
+        const Box& bx = fab.box();
+
+        for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+        {
+            fab(iv,0) = std::sin(0.1*iv[0]) * std::cos(0.05*iv[1]) + 1.e-3*iv[BL_SPACEDIM-1];
+            fab(iv,1) = 1000.0 + iv[0] + 1.e-7*iv[1];
+            fab(iv,2) = mfi.index();
+        }
+    }
+
+    static const std::string cmf_name = "Spam-n-Eggs-Compressed";
+
+    const Real tol = 1.e-4;
+
+    const Real err0 = Write_N_Read_Compressed(smf, cmf_name, 0);
+    const Real err1 = Write_N_Read_Compressed(smf, cmf_name, tol);
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        std::cout << "Compressed:  relative error " << err0 << " lossless, "
+                  << err1 << " with tolerance " << tol << '\n';
+    }
+
+    if (err0 != 0 || err1 > tol)
+        BoxLib::Abort("tVisMF: compressed MultiFab read back wrong");
+    //
+    // Pruning with histograms.  The second component has a gap in every
+    // FAB that only the histograms can see.
+    //
+    MultiFab hmf(ba, 2, 0);
+
+    for (MFIter mfi(hmf); mfi.isValid(); ++mfi)
+    {
+        FArrayBox& fab = hmf[mfi];
+
+        const Box& bx = fab.box();
+
+        for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+        {
+            fab(iv,0) = 1000.0 + 10.0*std::sin(0.3*iv[0]) + 0.001*iv[1];
+            fab(iv,1) = (D_TERM(iv[0],+iv[1],+iv[2]) % 2 == 0) ? 1.0 + 0.01*iv[0] : 10.0 + 0.01*iv[1];
+        }
+    }
+
+    static const std::string hmf_name = "Spam-n-Eggs-Histograms";
+
+    int nerrors = 0;
+
+    nerrors += Check_MayContain(hmf, hmf_name, VisMF::Header::NoFabHeaderMinMax_v1, 0);
+    nerrors += Check_MayContain(hmf, hmf_name, VisMF::Header::NoFabHeaderCompressed_v1, 0);
+    nerrors += Check_MayContain(hmf, hmf_name, VisMF::Header::NoFabHeaderCompressed_v1, tol);
+    nerrors += Check_MayContain(hmf, hmf_name, VisMF::Header::NoFabHeaderCompressed_v1, 1.e-2);
+
+    FArrayBox::setFormat(FABio::FAB_IEEE_32);
+    nerrors += Check_MayContain(hmf, hmf_name, VisMF::Header::NoFabHeaderMinMax_v1, 0);
+    nerrors += Check_MayContain(hmf, hmf_name, VisMF::Header::NoFabHeaderCompressed_v1, tol);
+    FArrayBox::setFormat(FABio::FAB_NATIVE);
+
+    if (nerrors > 0)
+        BoxLib::Abort("tVisMF: mayContain() pruned a FAB holding a value in range");
+    //
+    // Mapped FABs, which only the native format without fab headers has.
+    //
+    const FABio::Format formats[] = { FABio::FAB_NATIVE, FABio::FAB_IEEE_32, FABio::FAB_NATIVE_32 };
+
+    for (int f = 0; f < 3; ++f)
+    {
+        FArrayBox::setFormat(formats[f]);
+
+        for (int v = VisMF::Header::Version_v1; v <= VisMF::Header::NoFabHeaderCompressed_v1; ++v)
+            nerrors += Check_MapFAB(smf, cmf_name, VisMF::Header::Version(v));
+    }
+
+    FArrayBox::setFormat(FABio::FAB_NATIVE);
+
+    if (nerrors > 0)
+        BoxLib::Abort("tVisMF: mapFAB() differs from readFAB()");
+    //
+    // Asynchronous writes in each binary format and header version, to a
+    // file per rank and with all ranks sharing one file.
+    //
+    static const std::string amf_name = "Spam-n-Eggs-Async";
+
+    const int nOutFiles[] = { VisMF::GetNOutFiles(), 1 };
+
+    for (int nf = 0; nf < 2; ++nf)
+    {
+        VisMF::SetNOutFiles(nOutFiles[nf]);
+
+        for (int f = 0; f < 3; ++f)
+        {
+            FArrayBox::setFormat(formats[f]);
+
+            for (int v = VisMF::Header::Version_v1; v <= VisMF::Header::NoFabHeaderCompressed_v1; ++v)
+                nerrors += Check_AsyncWrite(smf, amf_name, VisMF::Header::Version(v));
+        }
+    }
+
+    VisMF::SetNOutFiles(nOutFiles[0]);
+
+    FArrayBox::setFormat(FABio::FAB_NATIVE);
+
+    if (nerrors > 0)
+        BoxLib::Abort("tVisMF: AsyncWrite() differs from Write()");
 
     BoxLib::Finalize();
 }
@@ -0,0 +1,219 @@
+//
+// A test program for sMultiFab:  FillBoundary(), periodic FillBoundary(),
+// copy(), the Copy() round trip to a MultiFab and Write()/Read() must give
+// what the same operations on a MultiFab give.  The values are small
+// integers, so that they are exact in single precision.
+//
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+#include <BoxLib.H>
+#include <MultiFab.H>
+#include <sMultiFab.H>
+#include <VisMF.H>
+#include <NFiles.H>
+
+static int nerrors(0);
+
+static void
+check (bool ok, const std::string& what)
+{
+    if (!ok) {
+        if (ParallelDescriptor::IOProcessor())
+            std::cout << "**** failed:  " << what << std::endl;
+        ++nerrors;
+    }
+}
+//
+// smf promoted must equal mf, ghost cells included.
+//
+static void
+check (const sMultiFab& smf, const MultiFab& mf, const std::string& what)
+{
+    MultiFab diff(mf.boxArray(), mf.nComp(), mf.nGrow(), mf.DistributionMap());
+
+    sMultiFab::Copy(diff, smf, 0, 0, mf.nComp(), mf.nGrow());
+
+    diff.minus(mf, 0, mf.nComp(), mf.nGrow());
+
+    for (int n = 0; n < mf.nComp(); ++n)
+        check(diff.norm0(n, mf.nGrow()) == 0, what);
+}
+
+static std::string
+contents (const std::string& filename)
+{
+    std::ifstream ifs(filename.c_str(), std::ios::binary);
+
+    return std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+}
+
+int
+main (int argc, char** argv)
+{
+    BoxLib::Initialize(argc, argv);
+
+    const int N = 32, ncomp = 2, ngrow = 2;
+
+    BoxArray ba(Box(IntVect::TheZeroVector(),IntVect(D_DECL(N-1,N-1,N-1))));
+    ba.maxSize(8);
+
+    MultiFab  mf(ba,ncomp,ngrow);
+    sMultiFab smf(ba,ncomp,ngrow);
+
+    mf.setVal(-1);
+
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.validbox();
+
+        for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+        {
+            const int h = D_TERM(iv[0], + N*iv[1], + N*N*iv[2]);
+            mf[mfi](iv,0) = h;
+            mf[mfi](iv,1) = (h % 97) - 48;
+        }
+    }
+
+    sMultiFab::Copy(smf, mf, 0, 0, ncomp, ngrow);
+    check(smf, mf, "Copy");
+    //
+    // Single components both ways.
+    //
+    {
+        MultiFab one(ba,1,ngrow);
+        sMultiFab::Copy(one, smf, 1, 0, 1, ngrow);
+        MultiFab::Subtract(one, mf, 1, 0, 1, ngrow);
+        check(one.norm0(0, ngrow) == 0, "Copy of component 1");
+
+        sMultiFab sone(ba,1,ngrow);
+        sMultiFab::Copy(sone, mf, 0, 0, 1, ngrow);
+        sMultiFab::Copy(one, sone, 0, 0, 1, ngrow);
+        MultiFab::Subtract(one, mf, 0, 0, 1, ngrow);
+        check(one.norm0(0, ngrow) == 0, "Copy of component 0");
+    }
+
+    smf.FillBoundary();
+    mf.FillBoundary();
+    check(smf, mf, "FillBoundary");
+
+    const Periodicity period(IntVect(D_DECL(N,N,N)));
+
+    smf.FillBoundary(period);
+    mf.FillBoundary(period);
+    check(smf, mf, "periodic FillBoundary");
+    check(smf.min(1, ngrow) == mf.min(1, ngrow) && smf.max(0, ngrow) == mf.max(0, ngrow),
+          "min and max");
+    //
+    // copy() to a different BoxArray and back.
+    //
+    {
+        BoxArray ba2(Box(IntVect(D_DECL(-4,-4,-4)),IntVect(D_DECL(N+3,N+3,N+3))));
+        ba2.maxSize(16);
+
+        MultiFab  mf2(ba2,ncomp,1);
+        sMultiFab smf2(ba2,ncomp,1);
+
+        mf2.setVal(7);
+        smf2.setVal(7);
+        mf2.copy(mf);
+        smf2.copy(smf);
+        check(smf2, mf2, "copy");
+
+        mf2.copy(mf, 0, 0, ncomp, ngrow, 1, period);
+        smf2.copy(smf, 0, 0, ncomp, ngrow, 1, period);
+        check(smf2, mf2, "periodic copy with ghost cells");
+    }
+    //
+    // Write() and Read() in each header version:  Read() and VisMF::Read()
+    // must give the values back, and the data files must be those
+    // VisMF::Write() makes of the MultiFab in FAB_IEEE_32.
+    //
+    const VisMF::Header::Version oldVersion = VisMF::GetHeaderVersion();
+    const int oldNOutFiles = VisMF::GetNOutFiles();
+
+    VisMF::SetNOutFiles(1);
+    VisMF::SetNHistogramBins(8);
+
+    for (int v = VisMF::Header::Version_v1; v <= VisMF::Header::NoFabHeaderCompressed_v1; ++v)
+    {
+        const VisMF::Header::Version version = VisMF::Header::Version(v);
+        const std::string vs = BoxLib::Concatenate("version ", v, 1);
+
+        VisMF::SetHeaderVersion(version);
+
+        sMultiFab::Write(smf, "tsMF_smf");
+
+        const FABio::Format fmt = FArrayBox::getFormat();
+        FArrayBox::setFormat(FABio::FAB_IEEE_32);
+        VisMF::Write(mf, "tsMF_mf");
+        FArrayBox::setFormat(fmt);
+
+        check(FArrayBox::getFormat() == fmt, "Write restores the format, " + vs);
+
+        sMultiFab snew;
+        sMultiFab::Read(snew, "tsMF_smf");
+        check(snew.boxArray() == ba && snew.nComp() == ncomp && snew.nGrow() == ngrow,
+              "Read layout, " + vs);
+        check(snew, mf, "Write and Read, " + vs);
+
+        MultiFab mnew;
+        VisMF::Read(mnew, "tsMF_smf");
+        sMultiFab::Copy(smf, mnew, 0, 0, ncomp, ngrow);
+        check(smf, mf, "Write and VisMF::Read, " + vs);
+
+        if (version != VisMF::Header::NoFabHeader_v1)
+        {
+            VisMF vmf("tsMF_smf");
+
+            for (int n = 0; n < ncomp; ++n)
+            {
+                if (version == VisMF::Header::NoFabHeaderFAMinMax_v1)
+                {
+                    check(vmf.min(n) == mf.min(n) && vmf.max(n) == mf.max(n),
+                          "header min and max, " + vs);
+                    continue;
+                }
+
+                for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+                {
+                    const Box& bx = mfi.validbox();
+
+                    check(vmf.min(mfi.index(), n) == mf[mfi].min(bx, n) &&
+                          vmf.max(mfi.index(), n) == mf[mfi].max(bx, n),
+                          "header min and max, " + vs);
+                }
+            }
+        }
+
+        if (ParallelDescriptor::IOProcessor())
+        {
+            const std::string sname = NFilesIter::FileName(1, "tsMF_smf_D_", 0, true);
+            const std::string mname = NFilesIter::FileName(1, "tsMF_mf_D_", 0, true);
+
+            check(contents(sname) == contents(mname), "data file, " + vs);
+            check(contents("tsMF_smf_Hist") == contents("tsMF_mf_Hist"), "histograms, " + vs);
+        }
+    }
+
+    VisMF::SetNHistogramBins(0);
+    VisMF::SetHeaderVersion(oldVersion);
+
+    VisMF::RemoveFiles("tsMF_smf");
+    VisMF::RemoveFiles("tsMF_mf");
+
+    VisMF::SetNOutFiles(oldNOutFiles);
+
+    ParallelDescriptor::ReduceIntSum(nerrors);
+
+    if (ParallelDescriptor::IOProcessor())
+        std::cout << "tsMF:  " << nerrors << " errors" << std::endl;
+
+    if (nerrors > 0)
+        BoxLib::Abort("tsMF failed");
+
+    BoxLib::Finalize();
+}
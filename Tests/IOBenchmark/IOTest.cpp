@@ -227,6 +227,9 @@ void TestWriteNFiles(int nfiles, int maxgrid, int ncomps, int nboxes,
     case VisMF::Header::NoFabHeaderFAMinMax_v1:
       mfName = "TestMFNoFabHeaderFAMinMax";
     break;
+    case VisMF::Header::NoFabHeaderCompressed_v1:
+      mfName = "TestMFNoFabHeaderCompressed";
+    break;
     default:
       BoxLib::Abort("**** Error in TestWriteNFiles:  bad version.");
   }
@@ -70,6 +70,10 @@ static void PrintUsage(const char *progName) {
     cout << "   [usedss            = tf       ]" << '\n';
     cout << "   [usesyncreads      = tf       ]" << '\n';
     cout << "   [nmultifabs        = nmf      ]" << '\n';
+    cout << "   [useaggreads       = tf       ]" << '\n';
+    cout << "   [nreadaggregators  = nagg     ]" << '\n';
+    cout << "   [aggreadsize       = ars      ]" << '\n';
+    cout << "   [compresstol       = tol      ]" << '\n';
     cout << '\n';
     cout << "Running with default values." << '\n';
     cout << '\n';
@@ -106,6 +110,10 @@ int main(int argc, char *argv[]) {
   Array<int> testWriteNFilesVersions;
   Array<std::string> readFANames;
   int nReadStreams(1), nMultiFabs(1);
+  bool useAggReads(false);
+  int nReadAggregators(0);
+  long aggReadSize(VisMF::GetAggReadSize());
+  Real compressTol(0.0);
 
 
   pp.query("nfiles", nfiles);
@@ -159,6 +167,11 @@ int main(int argc, char *argv[]) {
   }
   pp.query("nreadstreams", nReadStreams);
   nReadStreams = std::max(1, nReadStreams);
+  pp.query("useaggreads", useAggReads);
+  pp.query("nreadaggregators", nReadAggregators);
+  pp.query("aggreadsize", aggReadSize);
+  aggReadSize = std::max(1L, aggReadSize);
+  pp.query("compresstol", compressTol);
 
 
   if(ParallelDescriptor::IOProcessor()) {
@@ -196,6 +209,10 @@ int main(int argc, char *argv[]) {
     cout << "usedss            = " << useDSS << '\n';
     cout << "usesyncreads      = " << useSyncReads << '\n';
     cout << "nmultifabs        = " << nMultiFabs << '\n';
+    cout << "useaggreads       = " << useAggReads << '\n';
+    cout << "nreadaggregators  = " << nReadAggregators << '\n';
+    cout << "aggreadsize       = " << aggReadSize << '\n';
+    cout << "compresstol       = " << compressTol << '\n';
 
     cout << '\n';
     cout << "sizeof(int) = " << sizeof(int) << '\n';
@@ -325,6 +342,10 @@ int main(int argc, char *argv[]) {
       case 4:
         hVersion = VisMF::Header::NoFabHeaderFAMinMax_v1;
       break;
+      case 5:
+        hVersion = VisMF::Header::NoFabHeaderCompressed_v1;
+        VisMF::SetCompressTolerance(compressTol);
+      break;
       default:
         BoxLib::Abort("**** Error:  bad hVersion.");
       }
@@ -356,6 +377,9 @@ int main(int argc, char *argv[]) {
 
   if(testreadmf) {
     VisMF::SetMFFileInStreams(nReadStreams);
+    VisMF::SetUseAggregatedReads(useAggReads);
+    VisMF::SetNReadAggregators(nReadAggregators);
+    VisMF::SetAggReadSize(aggReadSize);
     for(int itimes(0); itimes < ntimes; ++itimes) {
       ParallelDescriptor::Barrier("TestReadMF::BeforeSleep4");
       BoxLib::USleep(4);
@@ -112,6 +112,7 @@ print_usage (int,
 	<< "    nGrowPer = <#> number of lev-0 cells by which to" << endl
 	<< "               extend periodic boundaries  (default 0)" << endl
 	<< "    sComp = start comp  (default 0)" << endl
+	<< "    usemmap = map the plotfile data instead of reading them  (default 0)" << endl
 	<< "    connect_cc = Generate flattened structure by connecting cells centers,"
         << "                 otherwise, generate node at all cell corners and copy cc"
         << "                 value out (default 1)" << endl
@@ -325,6 +326,10 @@ main (int   argc,
     if (verbose>1)
         AmrData::SetVerbose(true);
 
+    bool useMMap = false;
+    pp.query("usemmap",useMMap);
+    AmrData::SetUseMMap(useMMap);
+
     std::string infile; pp.get("infile",infile);
     std::string outfile_DEF;
 
@@ -30,6 +30,7 @@ PrintUsage (const char* progName)
     std::cout << "   [outfile=outputFileName]" << '\n';
     std::cout << "   [-help]" << '\n';
     std::cout << "   [-verbose]" << '\n';
+    std::cout << "   [usemmap=tf]  map the plotfile data instead of reading them" << '\n';
     std::cout << '\n';
     std::cout << " Note: outfile required if verbose used" << '\n';
     exit(1);
@@ -60,6 +61,10 @@ main (int   argc,
       verbose = true;
       AmrData::SetVerbose(true);
     }
+
+    bool useMMap(false);
+    pp.query("usemmap", useMMap);
+    AmrData::SetUseMMap(useMMap);
     std::string tmpFile;
     pp.query("infile", iFile);
     if (iFile.empty())